@@ -0,0 +1,201 @@
+#include "AudioWorkerPool.h"
+#include "RealtimeScratch.h"
+
+#if JUCE_INTEL
+    #include <immintrin.h>
+#endif
+
+namespace
+{
+    // Spin-wait hint so a spinning thread doesn't starve its hyperthread sibling
+    inline void cpuRelax()
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #elif JUCE_ARM && ! JUCE_MSVC
+        __asm__ __volatile__ ("yield");
+       #endif
+    }
+
+    constexpr int WORKER_SPIN_ITERATIONS = 4000;  // Roughly 20-100 us before a worker sleeps
+    constexpr int WORKER_SLEEP_TIMEOUT_MS = 100;  // Re-check threadShouldExit() while asleep
+}
+
+// ============================================================================
+// Worker
+// ============================================================================
+
+class AudioWorkerPool::Worker : public juce::Thread
+{
+public:
+    Worker(AudioWorkerPool& ownerPool, int workerIndex)
+        : juce::Thread("Uhbik Audio Worker " + juce::String(workerIndex + 1)),
+          pool(ownerPool), wake(ownerPool.wakeSignals[static_cast<size_t>(workerIndex)])
+    {}
+
+    void run() override
+    {
+        // Only pick up batches published after we started
+        uint32_t lastBatch = static_cast<uint32_t>(pool.jobState.load() >> 32);
+
+        while (!threadShouldExit())
+        {
+            const uint32_t batch = waitForBatch(lastBatch);
+            if (batch == lastBatch)
+                continue;
+
+            lastBatch = batch;
+            pool.runJobs(batch);
+        }
+    }
+
+    // Signal the thread to exit and kick it out of its sleep
+    void requestExit()
+    {
+        signalThreadShouldExit();
+        wake.event.signal();
+    }
+
+private:
+    uint32_t currentBatch() const { return static_cast<uint32_t>(pool.jobState.load() >> 32); }
+
+    uint32_t waitForBatch(uint32_t lastBatch)
+    {
+        for (int i = 0; i < WORKER_SPIN_ITERATIONS; ++i)
+        {
+            const uint32_t batch = currentBatch();
+            if (batch != lastBatch)
+                return batch;
+            cpuRelax();
+        }
+
+        // Announce we're going to sleep, then check once more - dispatch() either
+        // sees the flag and signals us, or we see its batch here
+        wake.sleeping.store(true);
+        const uint32_t batch = currentBatch();
+        if (batch == lastBatch && !threadShouldExit())
+            wake.event.wait(WORKER_SLEEP_TIMEOUT_MS);
+        wake.sleeping.store(false);
+
+        return currentBatch();
+    }
+
+    AudioWorkerPool& pool;
+    WakeSignal& wake;
+};
+
+// ============================================================================
+// AudioWorkerPool
+// ============================================================================
+
+AudioWorkerPool::AudioWorkerPool() = default;
+
+AudioWorkerPool::~AudioWorkerPool()
+{
+    stopWorkers();
+}
+
+void AudioWorkerPool::setNumWorkers(int numWorkers)
+{
+    numWorkers = juce::jlimit(0, MAX_WORKERS, numWorkers);
+    if (numWorkers == numActiveWorkers.load() && static_cast<int>(workers.size()) == numWorkers)
+        return;
+
+    stopWorkers();
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        auto worker = std::make_unique<Worker>(*this, i);
+        if (!worker->startRealtimeThread(juce::Thread::RealtimeOptions{}))
+            worker->startThread(juce::Thread::Priority::highest);
+        workers.push_back(std::move(worker));
+    }
+
+    numActiveWorkers.store(numWorkers);
+}
+
+void AudioWorkerPool::stopWorkers()
+{
+    // New batches run inline from here on
+    numActiveWorkers.store(0);
+
+    for (auto& worker : workers)
+        worker->requestExit();
+
+    // A worker in the middle of a job finishes it before exiting
+    for (auto& worker : workers)
+        worker->stopThread(2000);
+
+    workers.clear();
+}
+
+void AudioWorkerPool::dispatch(int numJobs, JobFunction function, void* context)
+{
+    if (numJobs <= 0)
+        return;
+
+    jassert(numJobs <= MAX_JOBS);
+    numJobs = juce::jmin(numJobs, MAX_JOBS);
+
+    const int numWorkers = numActiveWorkers.load();
+    if (numWorkers == 0 || numJobs == 1)
+    {
+        for (int i = 0; i < numJobs; ++i)
+            function(context, i);
+        return;
+    }
+
+    jobFunction = function;
+    jobContext = context;
+    numJobsDone.store(0);
+
+    // Publishing the new batch id releases everything written above
+    const uint32_t batch = ++batchCounter;
+    jobState.store((static_cast<uint64_t>(batch) << 32) | (static_cast<uint64_t>(numJobs) << 16));
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        auto& wake = wakeSignals[static_cast<size_t>(i)];
+        if (wake.sleeping.exchange(false))
+            wake.event.signal();
+    }
+
+    runJobs(batch);
+
+    while (numJobsDone.load(std::memory_order_acquire) < numJobs)
+        cpuRelax();
+}
+
+bool AudioWorkerPool::claimJob(uint32_t batch, int& index)
+{
+    uint64_t state = jobState.load();
+    for (;;)
+    {
+        // A stale worker must never take an index from a newer batch
+        if (static_cast<uint32_t>(state >> 32) != batch)
+            return false;
+
+        const int next = static_cast<int>(state & 0xffffu);
+        const int numJobs = static_cast<int>((state >> 16) & 0xffffu);
+        if (next >= numJobs)
+            return false;
+
+        if (jobState.compare_exchange_weak(state, state + 1))
+        {
+            index = next;
+            return true;
+        }
+    }
+}
+
+void AudioWorkerPool::runJobs(uint32_t batch)
+{
+    ScopedAudioThread audioThreadScope;
+
+    int index = 0;
+    while (claimJob(batch, index))
+    {
+        jobFunction(jobContext, index);
+        numJobsDone.fetch_add(1, std::memory_order_release);
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Real-time worker pool used to process parallel chain branches.
+//
+// The audio thread hands out a batch of jobs with run(); workers and the audio
+// thread itself claim job indices from a single atomic counter, so handing out
+// jobs never locks or allocates. Idle workers spin briefly for the next batch
+// and then sleep; waking a sleeping worker signals its WaitableEvent, which
+// takes a mutex for a moment, so that is only done for workers that actually
+// went to sleep. The caller always takes part, so a batch completes even if no
+// worker wakes up in time - with zero workers everything runs inline.
+class AudioWorkerPool
+{
+public:
+    static constexpr int MAX_WORKERS = 16;
+    static constexpr int MAX_JOBS = 0xffff;  // Per batch
+
+    AudioWorkerPool();
+    ~AudioWorkerPool();
+
+    // Message thread - stops the current workers and starts numWorkers new ones.
+    // Safe while the audio thread is running: a batch in flight finishes on the
+    // remaining threads.
+    void setNumWorkers(int numWorkers);
+    int getNumWorkers() const { return numActiveWorkers.load(); }
+
+    // Audio thread - call job(index) for every index in [0, numJobs) across the
+    // pool and return once all of them have finished
+    template <typename Callable>
+    void run(int numJobs, Callable& job)
+    {
+        dispatch(numJobs, [](void* context, int index) { (*static_cast<Callable*>(context))(index); }, &job);
+    }
+
+private:
+    using JobFunction = void (*)(void* context, int jobIndex);
+
+    class Worker;
+
+    void dispatch(int numJobs, JobFunction function, void* context);
+    void runJobs(uint32_t batch);
+    bool claimJob(uint32_t batch, int& index);
+    void stopWorkers();
+
+    // Batch id in the top 32 bits, job count in the next 16 and the next job
+    // index in the bottom 16. Claims read all three in one load, so a stale
+    // worker can never pair an old index with a newer batch.
+    std::atomic<uint64_t> jobState{0};
+    std::atomic<int> numJobsDone{0};
+    JobFunction jobFunction = nullptr;  // Written before jobState is published
+    void* jobContext = nullptr;
+    uint32_t batchCounter = 0;          // Audio thread only
+
+    struct WakeSignal
+    {
+        juce::WaitableEvent event;
+        std::atomic<bool> sleeping{false};
+    };
+
+    // Fixed storage so the audio thread can wake workers while they are replaced
+    std::array<WakeSignal, MAX_WORKERS> wakeSignals;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<int> numActiveWorkers{0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioWorkerPool)
+};
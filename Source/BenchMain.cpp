@@ -0,0 +1,404 @@
+// UhbikBench - micro-benchmarks for the wrapper's realtime paths, run outside
+// any host so the numbers can be reproduced. Built with -DUHBIK_BUILD_BENCH=ON:
+//
+//     UhbikBench [group]...
+//
+// Runs every group when none is named. Each case prints its mean time per call.
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <iomanip>
+#include <iostream>
+#include <unordered_map>
+#include "CLAPEventQueue.h"
+#include "ChainStateFormat.h"
+#include "Ducker.h"
+#include "ModulationEngine.h"
+
+namespace
+{
+    constexpr double SAMPLE_RATE = 48000.0;
+    constexpr int BLOCK_SIZE = 512;
+
+    // Keeps results alive so the optimiser can't drop the work
+    volatile float sink = 0.0f;
+
+    // Call fn repeatedly for about targetMs and print the mean time per call
+    template <typename Fn>
+    double measure(const char* name, Fn&& fn, double targetMs = 250.0)
+    {
+        fn();  // Warm caches and lazy state
+
+        int iterations = 0;
+        double elapsedMs = 0.0;
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        do
+        {
+            for (int i = 0; i < 16; ++i)
+                fn();
+            iterations += 16;
+            elapsedMs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+        }
+        while (elapsedMs < targetMs);
+
+        const double microsPerCall = elapsedMs * 1000.0 / iterations;
+        std::cout << "  " << std::left << std::setw(48) << name << std::right << std::setw(12)
+                  << std::fixed << std::setprecision(3) << microsPerCall << " us" << std::endl;
+        return microsPerCall;
+    }
+
+    // ------------------------------------------------------------------------
+    // modulation: per-sample tick() of every source (the old path, keeping one
+    // value in MOD_BLOCK_SIZE) against ModulationEngine's block rendering
+    // ------------------------------------------------------------------------
+    void benchModulation()
+    {
+        constexpr int NUM_LFOS = 4, NUM_ENVELOPES = 2, NUM_STEP_SEQS = 2, NUM_MACROS = 8;
+        constexpr int MOD_BLOCK_SIZE = ModulationEngine::MOD_BLOCK_SIZE;
+
+        LFO lfos[NUM_LFOS];
+        Envelope envelopes[NUM_ENVELOPES];
+        StepSequencer stepSequencers[NUM_STEP_SEQS];
+        std::atomic<float>* macroParams[NUM_MACROS] = {};
+
+        const LFOWaveform waveforms[NUM_LFOS] = { LFOWaveform::Sine, LFOWaveform::Triangle,
+                                                  LFOWaveform::Saw, LFOWaveform::Square };
+        for (int i = 0; i < NUM_LFOS; ++i)
+        {
+            lfos[i].prepare(SAMPLE_RATE);
+            lfos[i].setWaveform(waveforms[i]);
+            lfos[i].setFrequency(0.5f + static_cast<float>(i));
+        }
+        for (auto& envelope : envelopes)
+        {
+            envelope.prepare(SAMPLE_RATE);
+            envelope.setSustain(0.5f);
+            envelope.trigger();
+        }
+        for (auto& sequencer : stepSequencers)
+            sequencer.prepare(SAMPLE_RATE);
+
+        ModulationEngine engine(NUM_LFOS, NUM_ENVELOPES, NUM_STEP_SEQS, NUM_MACROS);
+        engine.prepare(BLOCK_SIZE);
+
+        std::cout << "modulation (" << NUM_LFOS << " LFOs, " << NUM_ENVELOPES << " envelopes, "
+                  << NUM_STEP_SEQS << " step sequencers, " << BLOCK_SIZE << "-sample block)" << std::endl;
+
+        std::vector<float> controlPoints(static_cast<size_t>(BLOCK_SIZE / MOD_BLOCK_SIZE + 1));
+        const double perSample = measure("per-sample tick()", [&]
+        {
+            auto tickAll = [&](auto& source)
+            {
+                for (int n = 0; n < BLOCK_SIZE; ++n)
+                {
+                    const float value = source.tick();
+                    if (n % MOD_BLOCK_SIZE == 0)
+                        controlPoints[static_cast<size_t>(n / MOD_BLOCK_SIZE)] = value;
+                }
+            };
+
+            for (auto& lfo : lfos)
+                tickAll(lfo);
+            for (auto& envelope : envelopes)
+                tickAll(envelope);
+            for (auto& sequencer : stepSequencers)
+                tickAll(sequencer);
+            sink = controlPoints[0];
+        });
+
+        const double block = measure("ModulationEngine::render()", [&]
+        {
+            engine.render(lfos, envelopes, stepSequencers, macroParams, BLOCK_SIZE);
+            sink = engine.getRow(0)[0];
+        });
+
+        std::cout << "  speedup " << std::setprecision(1) << perSample / block << "x" << std::endl;
+    }
+
+    // ------------------------------------------------------------------------
+    // cookies: one block of CLAP_EVENT_PARAM_MOD events written into the input
+    // queue and consumed the way a typical plugin does - a param_id hash lookup
+    // per event, or the cookie the host passed back. No plugin is loaded; the
+    // consumer stands in for the plugin's side of the fast path.
+    // ------------------------------------------------------------------------
+    void benchCookies()
+    {
+        constexpr int NUM_PARAMS = 256;
+        constexpr int NUM_ROUTES = 32;
+        const int numModPoints = BLOCK_SIZE / ModulationEngine::MOD_BLOCK_SIZE;
+
+        struct Param
+        {
+            double modulation = 0.0;
+        };
+
+        // Sparse ids, as plugins tend to use
+        std::vector<Param> params(NUM_PARAMS);
+        std::unordered_map<clap_id, Param*> paramsById;
+        for (int i = 0; i < NUM_PARAMS; ++i)
+            paramsById[static_cast<clap_id>(i * 7919 + 13)] = &params[static_cast<size_t>(i)];
+
+        CLAPEventQueue queue;
+        queue.prepare(CLAPEventQueue::ModulationLane, static_cast<size_t>(NUM_ROUTES * numModPoints));
+
+        std::cout << "cookies (" << NUM_ROUTES << " routes x " << numModPoints << " points, "
+                  << NUM_PARAMS << " plugin parameters)" << std::endl;
+
+        auto runBlock = [&](bool useCookies)
+        {
+            for (int point = 0; point < numModPoints; ++point)
+            {
+                for (int r = 0; r < NUM_ROUTES; ++r)
+                {
+                    const auto paramIndex = static_cast<size_t>((r * 37) % NUM_PARAMS);
+                    auto* event = queue.append<clap_event_param_mod_t>(CLAPEventQueue::ModulationLane);
+                    event->header.size = sizeof(clap_event_param_mod_t);
+                    event->header.time = static_cast<uint32_t>(point * ModulationEngine::MOD_BLOCK_SIZE);
+                    event->header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+                    event->header.type = CLAP_EVENT_PARAM_MOD;
+                    event->header.flags = 0;
+                    event->param_id = static_cast<clap_id>(paramIndex * 7919 + 13);
+                    event->cookie = useCookies ? &params[paramIndex] : nullptr;
+                    event->note_id = -1;
+                    event->port_index = -1;
+                    event->channel = -1;
+                    event->key = -1;
+                    event->amount = 0.001 * r;
+                }
+            }
+
+            queue.finalise();
+
+            // The plugin's side
+            for (uint32_t i = 0; i < queue.size(); ++i)
+            {
+                const auto* event = reinterpret_cast<const clap_event_param_mod_t*>(queue.get(i));
+                auto* param = event->cookie != nullptr ? static_cast<Param*>(event->cookie)
+                                                       : paramsById.find(event->param_id)->second;
+                param->modulation = event->amount;
+            }
+
+            queue.clear();
+            sink = static_cast<float>(params[0].modulation);
+        };
+
+        const double lookup = measure("param_id lookup", [&] { runBlock(false); });
+        const double cookie = measure("cookie", [&] { runBlock(true); });
+        std::cout << "  speedup " << std::setprecision(1) << lookup / cookie << "x" << std::endl;
+    }
+
+    // ------------------------------------------------------------------------
+    // ducker: a stereo block keyed by a stereo sidechain. The reference is the
+    // per-sample loop the processor ran before Ducker (coefficients recomputed
+    // every block, getSample/setSample per channel).
+    // ------------------------------------------------------------------------
+    void benchDucker()
+    {
+        constexpr float THRESHOLD_DB = -20.0f, AMOUNT = 50.0f, ATTACK_MS = 5.0f, RELEASE_MS = 100.0f, HOLD_MS = 20.0f;
+
+        // Channels 0-1 main, 2-3 a noise burst every 100 ms on the sidechain
+        juce::AudioBuffer<float> source(4, BLOCK_SIZE * 16);
+        juce::Random random(1);
+        for (int ch = 0; ch < source.getNumChannels(); ++ch)
+        {
+            for (int n = 0; n < source.getNumSamples(); ++n)
+            {
+                const float level = ch < 2 || n % 4800 < 480 ? 0.5f : 0.001f;
+                source.setSample(ch, n, (random.nextFloat() * 2.0f - 1.0f) * level);
+            }
+        }
+
+        juce::AudioBuffer<float> buffer(4, BLOCK_SIZE);
+        int sourceBlock = 0;
+        auto nextBlock = [&]
+        {
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                buffer.copyFrom(ch, 0, source, ch, sourceBlock * BLOCK_SIZE, BLOCK_SIZE);
+            sourceBlock = (sourceBlock + 1) % (source.getNumSamples() / BLOCK_SIZE);
+        };
+
+        std::cout << "ducker (stereo main + stereo sidechain, " << BLOCK_SIZE << "-sample block)" << std::endl;
+
+        float envelope = 0.0f, holdCounter = 0.0f;
+        const double perSample = measure("per-sample follower", [&]
+        {
+            nextBlock();
+
+            const float sampleRate = static_cast<float>(SAMPLE_RATE);
+            const float attackCoef = std::exp(-1.0f / (sampleRate * ATTACK_MS * 0.001f));
+            const float releaseCoef = std::exp(-1.0f / (sampleRate * RELEASE_MS * 0.001f));
+            const float holdSamples = sampleRate * HOLD_MS * 0.001f;
+            const float thresholdLin = juce::Decibels::decibelsToGain(THRESHOLD_DB);
+            const float amount = AMOUNT / 100.0f;
+
+            for (int n = 0; n < BLOCK_SIZE; ++n)
+            {
+                const float scLevel = std::max(std::abs(buffer.getSample(2, n)), std::abs(buffer.getSample(3, n)));
+                const float targetEnv = scLevel > thresholdLin ? 1.0f : 0.0f;
+
+                if (targetEnv > envelope)
+                {
+                    envelope = attackCoef * envelope + (1.0f - attackCoef) * targetEnv;
+                    holdCounter = holdSamples;
+                }
+                else if (holdCounter > 0.0f)
+                {
+                    holdCounter -= 1.0f;
+                }
+                else
+                {
+                    envelope = releaseCoef * envelope + (1.0f - releaseCoef) * targetEnv;
+                }
+
+                const float gain = 1.0f - envelope * amount;
+                buffer.setSample(0, n, buffer.getSample(0, n) * gain);
+                buffer.setSample(1, n, buffer.getSample(1, n) * gain);
+            }
+            sink = envelope;
+        });
+
+        Ducker ducker;
+        ducker.prepare(SAMPLE_RATE, BLOCK_SIZE, 2, false);
+        sourceBlock = 0;
+        const double block = measure("Ducker::process()", [&]
+        {
+            nextBlock();
+            ducker.setParameters(THRESHOLD_DB, AMOUNT, ATTACK_MS, RELEASE_MS, HOLD_MS);
+            sink = ducker.process(buffer.getArrayOfWritePointers(), 2, buffer.getReadPointer(2),
+                                  buffer.getReadPointer(3), BLOCK_SIZE);
+        });
+
+        std::cout << "  speedup " << std::setprecision(1) << perSample / block << "x" << std::endl;
+    }
+
+    // ------------------------------------------------------------------------
+    // state: save and restore of a chain's plugin state blobs, as version 4 did
+    // (base64 in an XML tree) and as ChainStateFormat does (binary chunks)
+    // ------------------------------------------------------------------------
+    void benchState()
+    {
+        constexpr int NUM_SLOTS = 8;
+        constexpr size_t STATE_BYTES = 256 * 1024;
+
+        // Plugin states are typically part float data, part repeated structure
+        std::vector<juce::MemoryBlock> states;
+        juce::Random random(1);
+        for (int i = 0; i < NUM_SLOTS; ++i)
+        {
+            juce::MemoryBlock state(STATE_BYTES);
+            auto* bytes = static_cast<juce::uint8*>(state.getData());
+            for (size_t n = 0; n < STATE_BYTES; ++n)
+                bytes[n] = n % 64 < 16 ? static_cast<juce::uint8>(random.nextInt(256)) : static_cast<juce::uint8>(n % 7);
+            states.push_back(std::move(state));
+        }
+
+        std::cout << "state (" << NUM_SLOTS << " slots x " << STATE_BYTES / 1024 << " KB)" << std::endl;
+
+        juce::MemoryBlock xmlData;
+        const double xmlSave = measure("XML + base64 save", [&]
+        {
+            juce::XmlElement root("EffectChainState");
+            for (int i = 0; i < NUM_SLOTS; ++i)
+            {
+                auto* slot = root.createNewChildElement("Slot");
+                slot->setAttribute("index", i);
+                slot->setAttribute("pluginState", states[static_cast<size_t>(i)].toBase64Encoding());
+            }
+
+            // copyXmlToBinary() minus its 8-byte header, which needs juce_audio_processors
+            xmlData.reset();
+            juce::MemoryOutputStream out(xmlData, false);
+            root.writeTo(out, juce::XmlElement::TextFormat().singleLine().withoutHeader());
+            out.writeByte(0);
+            out.flush();
+            sink = static_cast<float>(xmlData.getSize());
+        });
+
+        const double xmlLoad = measure("XML + base64 load", [&]
+        {
+            const auto root = juce::parseXML(juce::String::fromUTF8(static_cast<const char*>(xmlData.getData())));
+            size_t total = 0;
+            for (auto* slot : root->getChildIterator())
+            {
+                juce::MemoryBlock state;
+                state.fromBase64Encoding(slot->getStringAttribute("pluginState"));
+                total += state.getSize();
+            }
+            sink = static_cast<float>(total);
+        });
+
+        juce::MemoryBlock binaryData;
+        const double binarySave = measure("ChainStateFormat save", [&]
+        {
+            ChainStateFormat::Writer writer;
+            for (int i = 0; i < NUM_SLOTS; ++i)
+                writer.addChunk(ChainStateFormat::pluginChunk, i, states[static_cast<size_t>(i)].getData(), STATE_BYTES);
+
+            binaryData.reset();
+            writer.writeTo(binaryData);
+            sink = static_cast<float>(binaryData.getSize());
+        });
+
+        const double binaryLoad = measure("ChainStateFormat load", [&]
+        {
+            ChainStateFormat::Reader reader;
+            size_t total = 0;
+            if (reader.open(binaryData.getData(), binaryData.getSize()))
+            {
+                for (int i = 0; i < NUM_SLOTS; ++i)
+                {
+                    juce::MemoryBlock state;
+                    if (reader.readChunk(ChainStateFormat::pluginChunk, i, state))
+                        total += state.getSize();
+                }
+            }
+            sink = static_cast<float>(total);
+        });
+
+        std::cout << "  size " << xmlData.getSize() / 1024 << " KB -> " << binaryData.getSize() / 1024 << " KB, save speedup "
+                  << std::setprecision(1) << xmlSave / binarySave << "x, load speedup " << xmlLoad / binaryLoad << "x"
+                  << std::endl;
+    }
+
+    struct BenchGroup
+    {
+        const char* name;
+        void (*run)();
+    };
+
+    const BenchGroup groups[] = {
+        { "modulation", benchModulation },
+        { "cookies", benchCookies },
+        { "ducker", benchDucker },
+        { "state", benchState },
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    bool ranAny = false;
+    for (const auto& group : groups)
+    {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i)
+            selected = selected || juce::String(argv[i]) == group.name;
+
+        if (selected)
+        {
+            group.run();
+            ranAny = true;
+        }
+    }
+
+    if (!ranAny)
+    {
+        std::cerr << "Usage: UhbikBench [group]...  Groups:";
+        for (const auto& group : groups)
+            std::cerr << " " << group.name;
+        std::cerr << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
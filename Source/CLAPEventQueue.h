@@ -0,0 +1,130 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <clap/clap.h>
+#include <vector>
+
+// Fixed-capacity input event queue for one hosted CLAP plugin.
+//
+// Each producer (modulation, MIDI/notes) writes into its own lane, directly
+// into preallocated storage, and must append in time order.
+// finalise() merges the lanes with a k-way merge into the order served to the
+// plugin, so there is no copying or sorting per block. Sized in prepare() on
+// the message thread; everything else is audio-thread safe.
+class CLAPEventQueue
+{
+public:
+    enum Lane
+    {
+        ModulationLane = 0,
+        NoteLane,
+        NUM_LANES
+    };
+
+    // Storage for one event of any type we send
+    union EventStorage
+    {
+        clap_event_header_t header;
+        clap_event_param_mod_t paramMod;
+        clap_event_note_t note;
+        clap_event_note_expression_t noteExpression;
+        clap_event_midi_t midi;
+    };
+
+    CLAPEventQueue() = default;
+
+    // Message thread - allocate capacity events for one lane
+    void prepare(Lane lane, size_t capacity)
+    {
+        lanes[lane].events.resize(capacity);
+        clear();
+
+        size_t total = 0;
+        for (const auto& l : lanes)
+            total += l.events.size();
+        ordered.reserve(total);
+    }
+
+    void clear()
+    {
+        for (auto& lane : lanes)
+            lane.count = 0;
+        ordered.clear();
+    }
+
+    // Reserve the next event in a lane and return it for the producer to fill
+    // in place (header included). Returns nullptr when the lane is full.
+    template <typename EventType>
+    EventType* append(Lane lane)
+    {
+        static_assert(sizeof(EventType) <= sizeof(EventStorage), "Event type not covered by EventStorage");
+
+        auto& l = lanes[lane];
+        if (l.count >= l.events.size())
+            return nullptr;
+
+        return reinterpret_cast<EventType*>(&l.events[l.count++]);
+    }
+
+    // Merge all lanes into time order. Each lane is already ordered, so this is
+    // a linear k-way merge (k = NUM_LANES); ties keep lane order.
+    void finalise()
+    {
+        ordered.clear();
+
+        size_t heads[NUM_LANES] = {};
+        for (;;)
+        {
+            int best = -1;
+            uint32_t bestTime = 0;
+            for (int i = 0; i < NUM_LANES; ++i)
+            {
+                const auto& l = lanes[i];
+                if (heads[i] < l.count)
+                {
+                    const uint32_t time = l.events[heads[i]].header.time;
+                    if (best < 0 || time < bestTime)
+                    {
+                        best = i;
+                        bestTime = time;
+                    }
+                }
+            }
+
+            if (best < 0)
+                break;
+
+            auto& l = lanes[best];
+            jassert(heads[best] == 0 || l.events[heads[best] - 1].header.time <= bestTime);  // Lane appended out of order
+            ordered.push_back(&l.events[heads[best]++].header);  // Capacity reserved in prepare()
+        }
+    }
+
+    // Served to the plugin through clap_input_events (after finalise())
+    uint32_t size() const { return static_cast<uint32_t>(ordered.size()); }
+
+    const clap_event_header_t* get(uint32_t index) const
+    {
+        return index < ordered.size() ? ordered[index] : nullptr;
+    }
+
+    bool isEmpty() const
+    {
+        for (const auto& lane : lanes)
+            if (lane.count > 0)
+                return false;
+        return true;
+    }
+
+private:
+    struct LaneStorage
+    {
+        std::vector<EventStorage> events;
+        size_t count = 0;
+    };
+
+    LaneStorage lanes[NUM_LANES];
+    std::vector<const clap_event_header_t*> ordered;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CLAPEventQueue)
+};
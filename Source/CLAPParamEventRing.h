@@ -0,0 +1,69 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <clap/clap.h>
+#include <vector>
+
+// Parameter events a hosted CLAP plugin sends back to the host (through
+// clap_output_events), reduced to what the message thread needs
+struct CLAPParamEvent
+{
+    enum Type : uint8_t
+    {
+        Value,
+        GestureBegin,
+        GestureEnd
+    };
+
+    Type type = Value;
+    clap_id paramId = CLAP_INVALID_ID;
+    double value = 0.0;  // Value events only
+};
+
+// Wait-free single-producer / single-consumer ring carrying CLAPParamEvents
+// from the thread running the plugin's process() (or params flush) to the
+// message thread. Sized in prepare() on the message thread while the plugin
+// isn't processing; push() and pop() never allocate or lock. When the ring is
+// full, push() fails and the event is reported as not accepted.
+class CLAPParamEventRing
+{
+public:
+    CLAPParamEventRing() = default;
+
+    // Message thread, nothing pushing or popping
+    void prepare(int capacity)
+    {
+        events.resize(static_cast<size_t>(juce::jmax(1, capacity)));
+        fifo.setTotalSize(static_cast<int>(events.size()));
+        fifo.reset();
+    }
+
+    // Producer
+    bool push(const CLAPParamEvent& event)
+    {
+        const auto scope = fifo.write(1);
+        if (scope.blockSize1 + scope.blockSize2 == 0)
+            return false;
+
+        events[static_cast<size_t>(scope.blockSize1 > 0 ? scope.startIndex1 : scope.startIndex2)] = event;
+        return true;
+    }
+
+    // Consumer - pop everything available, oldest first, into callback
+    template <typename Callback>
+    int popAll(Callback&& callback)
+    {
+        const auto scope = fifo.read(fifo.getNumReady());
+        for (int i = 0; i < scope.blockSize1; ++i)
+            callback(events[static_cast<size_t>(scope.startIndex1 + i)]);
+        for (int i = 0; i < scope.blockSize2; ++i)
+            callback(events[static_cast<size_t>(scope.startIndex2 + i)]);
+        return scope.blockSize1 + scope.blockSize2;
+    }
+
+private:
+    std::vector<CLAPParamEvent> events;
+    juce::AbstractFifo fifo { 1 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CLAPParamEventRing)
+};
@@ -1,4 +1,6 @@
 #include "CLAPPluginHost.h"
+#include "PluginScanCache.h"
+#include "RealtimeScratch.h"
 #include <clap/ext/params.h>
 #include <iostream>
 #include <algorithm>
@@ -15,14 +17,42 @@
     #define CLAP_UNLOAD_LIBRARY(lib) dlclose(lib)
 #endif
 
+namespace
+{
+    // Shared by every instance - see getCookieGeneration()
+    std::atomic<uint32_t> nextCookieGeneration{1};
+    std::atomic<uint64_t> nextInstanceId{1};
+
+    uint32_t newCookieGeneration()
+    {
+        return nextCookieGeneration.fetch_add(1);
+    }
+
+    // Points a CLAP port at 32- or 64-bit channel pointers; the other set must be null
+    void setPortData(clap_audio_buffer& port, float** channels)
+    {
+        port.data32 = channels;
+        port.data64 = nullptr;
+    }
+
+    void setPortData(clap_audio_buffer& port, double** channels)
+    {
+        port.data32 = nullptr;
+        port.data64 = channels;
+    }
+}
+
 // ============================================================================
 // CLAPPluginInstance
 // ============================================================================
 
 CLAPPluginInstance::CLAPPluginInstance(const CLAPPluginDescription& desc)
     : description(desc)
+    , cookieGeneration(newCookieGeneration())
+    , instanceId(nextInstanceId.fetch_add(1))
 {
     initHost();
+    outputParamEvents.prepare(MAX_OUTPUT_PARAM_EVENTS);
 }
 
 CLAPPluginInstance::~CLAPPluginInstance()
@@ -278,6 +308,34 @@ const void* CLAPPluginInstance::hostGetExtension(const clap_host* host, const ch
         return &hostGui;
     }
 
+    // Params support (rescan notifications invalidate cached cookies)
+    if (strcmp(extensionId, CLAP_EXT_PARAMS) == 0)
+    {
+        std::cerr << "[CLAP Host] Providing params extension" << std::endl;
+        return &hostParams;
+    }
+
+    // Latency support (delay compensation)
+    if (strcmp(extensionId, CLAP_EXT_LATENCY) == 0)
+    {
+        std::cerr << "[CLAP Host] Providing latency extension" << std::endl;
+        return &hostLatency;
+    }
+
+    // Thread check (plugins assert which thread calls them)
+    if (strcmp(extensionId, CLAP_EXT_THREAD_CHECK) == 0)
+    {
+        std::cerr << "[CLAP Host] Providing thread-check extension" << std::endl;
+        return &hostThreadCheck;
+    }
+
+    // Tail support (silent slots go to sleep once the tail has played out)
+    if (strcmp(extensionId, CLAP_EXT_TAIL) == 0)
+    {
+        std::cerr << "[CLAP Host] Providing tail extension" << std::endl;
+        return &hostTail;
+    }
+
     // Timer support (cross-platform)
     if (strcmp(extensionId, CLAP_EXT_TIMER_SUPPORT) == 0)
     {
@@ -297,14 +355,119 @@ const void* CLAPPluginInstance::hostGetExtension(const clap_host* host, const ch
     return nullptr;
 }
 
-void CLAPPluginInstance::hostRequestRestart(const clap_host* /*host*/)
+void CLAPPluginInstance::hostRequestRestart(const clap_host* host)
 {
     std::cerr << "[CLAP Host] Plugin requested restart" << std::endl;
+
+    // The plugin may rebuild its parameters on reactivation; the processor's
+    // timer does the deactivate/activate cycle on the main thread
+    auto* self = static_cast<CLAPPluginInstance*>(host->host_data);
+    self->cookieGeneration.store(newCookieGeneration());
+    self->restartRequested.store(true);
 }
 
-void CLAPPluginInstance::hostRequestProcess(const clap_host* /*host*/)
+// Static params host support structure
+clap_host_params CLAPPluginInstance::hostParams = {
+    &CLAPPluginInstance::hostParamsRescan,
+    &CLAPPluginInstance::hostParamsClear,
+    &CLAPPluginInstance::hostParamsRequestFlush
+};
+
+void CLAPPluginInstance::hostParamsRescan(const clap_host* host, clap_param_rescan_flags flags)
 {
-    // Plugin wants to be processed even without audio input
+    std::cerr << "[CLAP Host] params rescan: flags=" << flags << std::endl;
+
+    // Cookies are part of clap_param_info, so an info rescan can change them
+    if ((flags & (CLAP_PARAM_RESCAN_ALL | CLAP_PARAM_RESCAN_INFO)) != 0)
+    {
+        auto* self = static_cast<CLAPPluginInstance*>(host->host_data);
+        self->cookieGeneration.store(newCookieGeneration());
+    }
+}
+
+void CLAPPluginInstance::hostParamsClear(const clap_host* host, clap_id paramId, clap_param_clear_flags flags)
+{
+    std::cerr << "[CLAP Host] params clear: id=" << paramId << " flags=" << flags << std::endl;
+
+    // A cleared parameter may be gone, and its cookie with it
+    auto* self = static_cast<CLAPPluginInstance*>(host->host_data);
+    self->cookieGeneration.store(newCookieGeneration());
+}
+
+void CLAPPluginInstance::hostParamsRequestFlush(const clap_host* host)
+{
+    // Any thread. An active plugin flushes with the next process() call (woken
+    // if its slot is asleep); an inactive one from drainParamEvents().
+    auto* self = static_cast<CLAPPluginInstance*>(host->host_data);
+    self->flushRequested.store(true);
+    self->processRequested.store(true);
+}
+
+// Static latency host support structure
+clap_host_latency CLAPPluginInstance::hostLatency = {
+    &CLAPPluginInstance::hostLatencyChanged
+};
+
+void CLAPPluginInstance::hostLatencyChanged(const clap_host* host)
+{
+    std::cerr << "[CLAP Host] Plugin latency changed" << std::endl;
+    auto* self = static_cast<CLAPPluginInstance*>(host->host_data);
+    self->latencyChanged.store(true);
+}
+
+// Static thread-check host support structure
+clap_host_thread_check CLAPPluginInstance::hostThreadCheck = {
+    &CLAPPluginInstance::hostIsMainThread,
+    &CLAPPluginInstance::hostIsAudioThread
+};
+
+bool CLAPPluginInstance::hostIsMainThread(const clap_host* host)
+{
+    juce::ignoreUnused(host);
+    return juce::MessageManager::existsAndIsCurrentThread();
+}
+
+bool CLAPPluginInstance::hostIsAudioThread(const clap_host* host)
+{
+    juce::ignoreUnused(host);
+    return ScopedAudioThread::isCurrentThread();
+}
+
+uint32_t CLAPPluginInstance::getLatencySamples() const
+{
+    if (!plugin || !latencyExt || !activated)
+        return 0;
+    return latencyExt->get(plugin);
+}
+
+// Static tail host support structure
+clap_host_tail CLAPPluginInstance::hostTail = {
+    &CLAPPluginInstance::hostTailChanged
+};
+
+void CLAPPluginInstance::hostTailChanged(const clap_host* host)
+{
+    // Audio thread - re-queried by the next getTailSamples()
+    auto* self = static_cast<CLAPPluginInstance*>(host->host_data);
+    self->tailChanged.store(true);
+}
+
+uint32_t CLAPPluginInstance::getTailSamples()
+{
+    if (!plugin || !tailExt)
+        return UINT32_MAX;
+
+    if (tailChanged.exchange(false))
+        tailSamples = tailExt->get(plugin);
+
+    return tailSamples;
+}
+
+void CLAPPluginInstance::hostRequestProcess(const clap_host* host)
+{
+    // Plugin wants to be processed even without audio input - wakes a sleeping slot
+    auto* self = static_cast<CLAPPluginInstance*>(host->host_data);
+    self->processRequested.store(true);
 }
 
 void CLAPPluginInstance::hostRequestCallback(const clap_host* /*host*/)
@@ -316,20 +479,46 @@ void CLAPPluginInstance::hostRequestCallback(const clap_host* /*host*/)
 uint32_t CLAPPluginInstance::inputEventsSize(const clap_input_events* list)
 {
     auto* self = static_cast<CLAPPluginInstance*>(list->ctx);
-    return static_cast<uint32_t>(self->pendingModEvents.size());
+    return self->inputEventQueue.size();
 }
 
 const clap_event_header* CLAPPluginInstance::inputEventsGet(const clap_input_events* list, uint32_t index)
 {
     auto* self = static_cast<CLAPPluginInstance*>(list->ctx);
-    if (index < self->pendingModEvents.size())
-        return &self->pendingModEvents[index].header;
-    return nullptr;
+    return self->inputEventQueue.get(index);
 }
 
-bool CLAPPluginInstance::outputEventsTryPush(const clap_output_events* /*list*/, const clap_event_header* /*event*/)
+bool CLAPPluginInstance::outputEventsTryPush(const clap_output_events* list, const clap_event_header* event)
 {
-    return true;  // Accept but ignore output events for now
+    if (event == nullptr || event->space_id != CLAP_CORE_EVENT_SPACE_ID)
+        return true;  // Accepted and ignored
+
+    CLAPParamEvent paramEvent;
+    switch (event->type)
+    {
+        case CLAP_EVENT_PARAM_VALUE:
+        {
+            const auto* valueEvent = reinterpret_cast<const clap_event_param_value_t*>(event);
+            paramEvent.type = CLAPParamEvent::Value;
+            paramEvent.paramId = valueEvent->param_id;
+            paramEvent.value = valueEvent->value;
+            break;
+        }
+
+        case CLAP_EVENT_PARAM_GESTURE_BEGIN:
+        case CLAP_EVENT_PARAM_GESTURE_END:
+            paramEvent.type = event->type == CLAP_EVENT_PARAM_GESTURE_BEGIN ? CLAPParamEvent::GestureBegin
+                                                                             : CLAPParamEvent::GestureEnd;
+            paramEvent.paramId = reinterpret_cast<const clap_event_param_gesture_t*>(event)->param_id;
+            break;
+
+        default:
+            return true;  // Notes and MIDI from the plugin aren't used
+    }
+
+    // Wait-free; a full ring refuses the event rather than blocking
+    auto* self = static_cast<CLAPPluginInstance*>(list->ctx);
+    return self->outputParamEvents.push(paramEvent);
 }
 
 bool CLAPPluginInstance::load()
@@ -452,9 +641,12 @@ void CLAPPluginInstance::unload()
 
     factory = nullptr;
     audioPortsExt = nullptr;
+    audioPortsConfigExt = nullptr;
     paramsExt = nullptr;
     stateExt = nullptr;
     guiExt = nullptr;
+    latencyExt = nullptr;
+    notePortsExt = nullptr;
 
     if (libraryHandle)
     {
@@ -470,12 +662,20 @@ bool CLAPPluginInstance::queryExtensions()
 
     audioPortsExt = static_cast<const clap_plugin_audio_ports*>(
         plugin->get_extension(plugin, CLAP_EXT_AUDIO_PORTS));
+    audioPortsConfigExt = static_cast<const clap_plugin_audio_ports_config*>(
+        plugin->get_extension(plugin, CLAP_EXT_AUDIO_PORTS_CONFIG));
     paramsExt = static_cast<const clap_plugin_params*>(
         plugin->get_extension(plugin, CLAP_EXT_PARAMS));
     stateExt = static_cast<const clap_plugin_state*>(
         plugin->get_extension(plugin, CLAP_EXT_STATE));
     guiExt = static_cast<const clap_plugin_gui*>(
         plugin->get_extension(plugin, CLAP_EXT_GUI));
+    latencyExt = static_cast<const clap_plugin_latency*>(
+        plugin->get_extension(plugin, CLAP_EXT_LATENCY));
+    tailExt = static_cast<const clap_plugin_tail*>(
+        plugin->get_extension(plugin, CLAP_EXT_TAIL));
+    notePortsExt = static_cast<const clap_plugin_note_ports*>(
+        plugin->get_extension(plugin, CLAP_EXT_NOTE_PORTS));
 
     // Timer support (cross-platform)
     timerExt = static_cast<const clap_plugin_timer_support*>(
@@ -493,6 +693,39 @@ bool CLAPPluginInstance::queryExtensions()
     return true;
 }
 
+void CLAPPluginInstance::selectPortsConfig()
+{
+    if (!plugin || !audioPortsConfigExt || preferredMainChannels == 0)
+        return;
+
+    // First configuration whose main ports both match the host's main bus
+    const uint32_t configCount = audioPortsConfigExt->count(plugin);
+    for (uint32_t i = 0; i < configCount; ++i)
+    {
+        clap_audio_ports_config config;
+        if (!audioPortsConfigExt->get(plugin, i, &config))
+            continue;
+
+        if (config.has_main_input && config.has_main_output
+            && config.main_input_channel_count == preferredMainChannels
+            && config.main_output_channel_count == preferredMainChannels)
+        {
+            const bool selected = audioPortsConfigExt->select(plugin, config.id);
+            std::cerr << "[CLAP Host] Ports config '" << config.name << "' (" << preferredMainChannels << " ch): "
+                      << (selected ? "selected" : "rejected") << std::endl;
+            return;
+        }
+    }
+}
+
+uint32_t CLAPPluginInstance::getMainOutputChannels() const
+{
+    for (const auto& port : outputPorts)
+        if (port.isMain)
+            return port.channelCount;
+    return 0;
+}
+
 bool CLAPPluginInstance::setupAudioPorts()
 {
     inputPorts.clear();
@@ -519,7 +752,7 @@ bool CLAPPluginInstance::setupAudioPorts()
         if (audioPortsExt->get(plugin, i, true, &info))
         {
             bool isMain = (info.flags & CLAP_AUDIO_PORT_IS_MAIN) != 0;
-            inputPorts.push_back({info.channel_count, isMain});
+            inputPorts.push_back({info.channel_count, isMain, (info.flags & CLAP_AUDIO_PORT_SUPPORTS_64BITS) != 0});
             totalInputChannels += info.channel_count;
             std::cerr << "[CLAP Host] Input port " << i << ": " << info.channel_count
                       << " ch, " << (isMain ? "main" : "aux") << std::endl;
@@ -534,7 +767,7 @@ bool CLAPPluginInstance::setupAudioPorts()
         if (audioPortsExt->get(plugin, i, false, &info))
         {
             bool isMain = (info.flags & CLAP_AUDIO_PORT_IS_MAIN) != 0;
-            outputPorts.push_back({info.channel_count, isMain});
+            outputPorts.push_back({info.channel_count, isMain, (info.flags & CLAP_AUDIO_PORT_SUPPORTS_64BITS) != 0});
             totalOutputChannels += info.channel_count;
             std::cerr << "[CLAP Host] Output port " << i << ": " << info.channel_count
                       << " ch, " << (isMain ? "main" : "aux") << std::endl;
@@ -553,6 +786,38 @@ bool CLAPPluginInstance::setupAudioPorts()
     return true;
 }
 
+void CLAPPluginInstance::setupNotePorts()
+{
+    noteInputPort = -1;
+    noteInputDialects = 0;
+    sendClapNotes = false;
+
+    if (!plugin || !notePortsExt)
+        return;  // No note input - MIDI isn't forwarded
+
+    // The first note input that speaks CLAP notes or MIDI
+    const uint32_t portCount = notePortsExt->count(plugin, true);
+    for (uint32_t i = 0; i < portCount; ++i)
+    {
+        clap_note_port_info info;
+        if (!notePortsExt->get(plugin, i, true, &info))
+            continue;
+
+        const uint32_t dialects = info.supported_dialects & (CLAP_NOTE_DIALECT_CLAP | CLAP_NOTE_DIALECT_MIDI);
+        if (dialects == 0)
+            continue;
+
+        noteInputPort = static_cast<int>(i);
+        noteInputDialects = dialects;
+        sendClapNotes = (dialects & CLAP_NOTE_DIALECT_CLAP) != 0
+                        && (info.preferred_dialect == CLAP_NOTE_DIALECT_CLAP || (dialects & CLAP_NOTE_DIALECT_MIDI) == 0);
+
+        std::cerr << "[CLAP Host] Note input port " << i << ": "
+                  << (sendClapNotes ? "CLAP notes" : "MIDI") << std::endl;
+        return;
+    }
+}
+
 bool CLAPPluginInstance::activate(double sampleRate, uint32_t minFrameCount, uint32_t maxFrameCount)
 {
     if (!plugin || activated)
@@ -561,7 +826,10 @@ bool CLAPPluginInstance::activate(double sampleRate, uint32_t minFrameCount, uin
     currentSampleRate = sampleRate;
     currentBlockSize = maxFrameCount;
 
+    // Port configuration can only change while deactivated
+    selectPortsConfig();
     setupAudioPorts();
+    setupNotePorts();
 
     if (!plugin->activate(plugin, sampleRate, minFrameCount, maxFrameCount))
     {
@@ -569,23 +837,18 @@ bool CLAPPluginInstance::activate(double sampleRate, uint32_t minFrameCount, uin
         return false;
     }
 
-    // Allocate per-port buffer pointer arrays
-    inputPortBuffers.resize(inputPorts.size());
-    for (size_t port = 0; port < inputPorts.size(); ++port)
-        inputPortBuffers[port].resize(inputPorts[port].channelCount, nullptr);
-
-    outputPortBuffers.resize(outputPorts.size());
-    for (size_t port = 0; port < outputPorts.size(); ++port)
-        outputPortBuffers[port].resize(outputPorts[port].channelCount, nullptr);
+    // Per-port buffer pointer arrays and scratch, 64-bit only where the host may use it
+    preparePortBuffers(portBuffers32, maxFrameCount);
+    if (supportsDoublePrecision())
+        preparePortBuffers(portBuffers64, maxFrameCount);
 
     // Allocate CLAP audio buffer structures (one per port)
     inputAudioBuffers.resize(inputPorts.size());
     outputAudioBuffers.resize(outputPorts.size());
 
-    // Allocate scratch buffer for silent channels (sidechain, etc.)
-    uint32_t maxChannels = juce::jmax(totalInputChannels, totalOutputChannels);
-    scratchBuffer.setSize(static_cast<int>(maxChannels), static_cast<int>(maxFrameCount));
-    scratchBuffer.clear();
+    // Fixed-capacity event storage - process() must never grow it
+    inputEventQueue.prepare(CLAPEventQueue::ModulationLane, maxModulationEvents);
+    inputEventQueue.prepare(CLAPEventQueue::NoteLane, MAX_NOTE_EVENTS);
 
     // Start processing
     if (!plugin->start_processing(plugin))
@@ -595,6 +858,8 @@ bool CLAPPluginInstance::activate(double sampleRate, uint32_t minFrameCount, uin
         return false;
     }
 
+    processingStarted.store(true);
+    tailChanged.store(true);
     activated = true;
     std::cerr << "[CLAP Host] Plugin activated at " << sampleRate << " Hz" << std::endl;
     return true;
@@ -605,74 +870,159 @@ void CLAPPluginInstance::deactivate()
     if (!plugin || !activated)
         return;
 
-    plugin->stop_processing(plugin);
+    if (processingStarted.exchange(false))
+        plugin->stop_processing(plugin);
     plugin->deactivate(plugin);
     activated = false;
 
-    inputPortBuffers.clear();
-    outputPortBuffers.clear();
+    portBuffers32 = {};
+    portBuffers64 = {};
     inputAudioBuffers.clear();
     outputAudioBuffers.clear();
 
     std::cerr << "[CLAP Host] Plugin deactivated" << std::endl;
 }
 
-void CLAPPluginInstance::process(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /*midiMessages*/)
+void CLAPPluginInstance::suspendProcessing()
 {
-    if (!plugin || !activated)
-        return;
+    if (plugin && activated && processingStarted.exchange(false))
+        plugin->stop_processing(plugin);
+}
 
-    const int numSamples = buffer.getNumSamples();
-    const int numChannels = buffer.getNumChannels();  // Typically 2 (stereo)
+template <typename SampleType>
+void CLAPPluginInstance::preparePortBuffers(PortBuffers<SampleType>& buffers, uint32_t maxFrameCount)
+{
+    buffers.inputs.resize(inputPorts.size());
+    for (size_t port = 0; port < inputPorts.size(); ++port)
+        buffers.inputs[port].assign(inputPorts[port].channelCount, nullptr);
+
+    buffers.outputs.resize(outputPorts.size());
+    for (size_t port = 0; port < outputPorts.size(); ++port)
+        buffers.outputs[port].assign(outputPorts[port].channelCount, nullptr);
 
-    // Make sure scratch buffer is large enough
-    if (scratchBuffer.getNumSamples() < numSamples)
-        scratchBuffer.setSize(scratchBuffer.getNumChannels(), numSamples);
+    // One shared silent input channel, zeroed here once (the plugin never writes
+    // its inputs), and a discard channel per output that may go unmapped
+    buffers.silent.setSize(1, static_cast<int>(maxFrameCount));
+    buffers.silent.clear();
+    buffers.auxOutput.setSize(static_cast<int>(juce::jmax(1u, totalOutputChannels)), static_cast<int>(maxFrameCount));
+}
 
-    // Clear scratch buffer for this block (used for silent sidechain channels)
-    scratchBuffer.clear();
+bool CLAPPluginInstance::supportsDoublePrecision() const
+{
+    auto supports64 = [](const std::vector<AudioPortInfo>& ports)
+    {
+        return std::all_of(ports.begin(), ports.end(), [](const AudioPortInfo& port) { return port.supports64; });
+    };
 
-    // Track which JUCE buffer channel we're at
-    int juceChannel = 0;
-    int scratchChannel = 0;
+    return plugin != nullptr && !inputPorts.empty() && supports64(inputPorts) && supports64(outputPorts);
+}
+
+clap_process_status CLAPPluginInstance::process(juce::AudioBuffer<float>& buffer, int numMainChannels,
+                                                juce::MidiBuffer& midiMessages, uint64_t constantChannels)
+{
+    addMidiEvents(midiMessages, buffer.getNumSamples());
+    return processBuffer(buffer, numMainChannels, constantChannels);
+}
+
+clap_process_status CLAPPluginInstance::process(juce::AudioBuffer<double>& buffer, int numMainChannels,
+                                                juce::MidiBuffer& midiMessages, uint64_t constantChannels)
+{
+    // Not allocated (and not allowed) unless every port supports 64-bit
+    jassert(portBuffers64.inputs.size() == inputPorts.size());
+    if (portBuffers64.inputs.size() != inputPorts.size())
+    {
+        inputEventQueue.clear();
+        return CLAP_PROCESS_ERROR;
+    }
+
+    addMidiEvents(midiMessages, buffer.getNumSamples());
+    return processBuffer(buffer, numMainChannels, constantChannels);
+}
+
+template <typename SampleType>
+clap_process_status CLAPPluginInstance::processBuffer(juce::AudioBuffer<SampleType>& buffer, int numMainChannels,
+                                                      uint64_t constantChannels)
+{
+    if (!plugin || !activated)
+        return CLAP_PROCESS_ERROR;
+
+    // Waking up from sleep
+    if (!processingStarted.load())
+    {
+        if (!plugin->start_processing(plugin))
+        {
+            inputEventQueue.clear();
+            return CLAP_PROCESS_ERROR;
+        }
+        processingStarted.store(true);
+    }
+
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = buffer.getNumChannels();
+    if (numSamples > static_cast<int>(currentBlockSize))
+    {
+        inputEventQueue.clear();
+        return CLAP_PROCESS_ERROR;  // Longer than activate() allowed for
+    }
 
-    // Setup input port buffers
-    // Port 0 (main) gets real audio, other ports (sidechain) get silence
+    // Map ports straight onto the JUCE buffer: the main ports onto channels
+    // [0, numMainChannels) (in place), the first aux input onto the sidechain
+    // channels after them. Inputs with nothing to map read the shared silent
+    // channel; every unmapped output gets its own discard channel.
+    auto& ports = getPortBuffers<SampleType>();
+    const SampleType* silence = ports.silent.getReadPointer(0);
+    int auxOutputChannel = 0;
+    bool sidechainMapped = false;
+
+    // Setup input port buffers. Constant channels (silence included) are
+    // flagged so the plugin can skip them.
     for (size_t port = 0; port < inputPorts.size(); ++port)
     {
         uint32_t portChannels = inputPorts[port].channelCount;
         bool isMain = inputPorts[port].isMain;
+        uint64_t constantMask = 0;
+
+        int firstChannel = -1;  // Buffer channel for channel 0 of this port, -1 for silence
+        int lastChannel = -1;
+        if (isMain)
+        {
+            firstChannel = 0;
+            lastChannel = juce::jmin(numMainChannels, numChannels);
+        }
+        else if (!sidechainMapped)
+        {
+            sidechainMapped = true;
+            firstChannel = numMainChannels;
+            lastChannel = numChannels;
+        }
 
         for (uint32_t ch = 0; ch < portChannels; ++ch)
         {
-            if (isMain && juceChannel < numChannels)
+            const int juceChannel = firstChannel + static_cast<int>(ch);
+            if (firstChannel >= 0 && juceChannel < lastChannel)
             {
-                // Main port - use real audio from JUCE buffer
-                inputPortBuffers[port][ch] = buffer.getWritePointer(juceChannel);
-                juceChannel++;
+                ports.inputs[port][ch] = buffer.getWritePointer(juceChannel);
+                if (ch < 64 && juceChannel < 64 && ((constantChannels >> juceChannel) & 1) != 0)
+                    constantMask |= uint64_t(1) << ch;
             }
             else
             {
-                // Aux port (sidechain) or no more real channels - use silence
-                inputPortBuffers[port][ch] = scratchBuffer.getWritePointer(scratchChannel % scratchBuffer.getNumChannels());
-                scratchChannel++;
+                // The plugin only reads its inputs, so all silent channels share one
+                ports.inputs[port][ch] = const_cast<SampleType*>(silence);
+                if (ch < 64)
+                    constantMask |= uint64_t(1) << ch;
             }
         }
 
         // Setup the CLAP audio buffer for this port
-        inputAudioBuffers[port].data32 = inputPortBuffers[port].data();
-        inputAudioBuffers[port].data64 = nullptr;
+        setPortData(inputAudioBuffers[port], ports.inputs[port].data());
         inputAudioBuffers[port].channel_count = portChannels;
         inputAudioBuffers[port].latency = 0;
-        inputAudioBuffers[port].constant_mask = 0;
+        inputAudioBuffers[port].constant_mask = constantMask;
     }
 
-    // Reset for output
-    juceChannel = 0;
-    scratchChannel = 0;
-
     // Setup output port buffers
-    // Port 0 (main) writes to JUCE buffer, other ports write to scratch
+    // The main port writes to the JUCE buffer, everything else is discarded
     for (size_t port = 0; port < outputPorts.size(); ++port)
     {
         uint32_t portChannels = outputPorts[port].channelCount;
@@ -680,23 +1030,15 @@ void CLAPPluginInstance::process(juce::AudioBuffer<float>& buffer, juce::MidiBuf
 
         for (uint32_t ch = 0; ch < portChannels; ++ch)
         {
-            if (isMain && juceChannel < numChannels)
-            {
-                // Main port - write to real JUCE buffer
-                outputPortBuffers[port][ch] = buffer.getWritePointer(juceChannel);
-                juceChannel++;
-            }
+            const int juceChannel = static_cast<int>(ch);
+            if (isMain && juceChannel < juce::jmin(numMainChannels, numChannels))
+                ports.outputs[port][ch] = buffer.getWritePointer(juceChannel);
             else
-            {
-                // Aux port or no more real channels - write to scratch (discarded)
-                outputPortBuffers[port][ch] = scratchBuffer.getWritePointer(scratchChannel % scratchBuffer.getNumChannels());
-                scratchChannel++;
-            }
+                ports.outputs[port][ch] = ports.auxOutput.getWritePointer(auxOutputChannel++);
         }
 
         // Setup the CLAP audio buffer for this port
-        outputAudioBuffers[port].data32 = outputPortBuffers[port].data();
-        outputAudioBuffers[port].data64 = nullptr;
+        setPortData(outputAudioBuffers[port], ports.outputs[port].data());
         outputAudioBuffers[port].channel_count = portChannels;
         outputAudioBuffers[port].latency = 0;
         outputAudioBuffers[port].constant_mask = 0;
@@ -714,8 +1056,104 @@ void CLAPPluginInstance::process(juce::AudioBuffer<float>& buffer, juce::MidiBuf
     processContext.in_events = &inputEvents;
     processContext.out_events = &outputEvents;
 
+    // Merge the per-producer lanes into time order
+    inputEventQueue.finalise();
+
     // Process!
-    plugin->process(plugin, &processContext);
+    const auto status = plugin->process(plugin, &processContext);
+
+    inputEventQueue.clear();
+    return status;
+}
+
+void CLAPPluginInstance::addModulationEvent(uint32_t sampleOffset, clap_id paramId, void* cookie, double amount)
+{
+    auto* event = inputEventQueue.append<clap_event_param_mod_t>(CLAPEventQueue::ModulationLane);
+    if (event == nullptr)
+    {
+        droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    event->header.size = sizeof(clap_event_param_mod_t);
+    event->header.time = sampleOffset;
+    event->header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+    event->header.type = CLAP_EVENT_PARAM_MOD;
+    event->header.flags = 0;
+
+    event->param_id = paramId;
+    event->cookie = cookie;
+    event->note_id = -1;      // Global modulation (not per-note)
+    event->port_index = -1;
+    event->channel = -1;
+    event->key = -1;
+    event->amount = amount;
+}
+
+void CLAPPluginInstance::addMidiEvents(const juce::MidiBuffer& midiMessages, int numSamples)
+{
+    if (noteInputPort < 0 || numSamples <= 0 || midiMessages.isEmpty())
+        return;
+
+    const auto portIndex = static_cast<int16_t>(noteInputPort);
+    const bool sendMidi = (noteInputDialects & CLAP_NOTE_DIALECT_MIDI) != 0;
+
+    // MidiBuffer iterates in time order, so the lane stays ordered
+    for (const auto metadata : midiMessages)
+    {
+        const juce::uint8* data = metadata.data;
+        if (metadata.numBytes < 1 || metadata.numBytes > 3 || data[0] < 0x80 || data[0] >= 0xf0)
+            continue;  // SysEx, system and running-status messages
+
+        const auto time = static_cast<uint32_t>(juce::jlimit(0, numSamples - 1, metadata.samplePosition));
+        const int status = data[0] & 0xf0;
+        const int data1 = metadata.numBytes > 1 ? data[1] : 0;
+        const int data2 = metadata.numBytes > 2 ? data[2] : 0;
+
+        if (sendClapNotes && (status == 0x90 || status == 0x80))
+        {
+            auto* event = inputEventQueue.append<clap_event_note_t>(CLAPEventQueue::NoteLane);
+            if (event == nullptr)
+            {
+                droppedEvents.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            const bool noteOn = status == 0x90 && data2 > 0;
+            event->header.size = sizeof(clap_event_note_t);
+            event->header.time = time;
+            event->header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+            event->header.type = noteOn ? CLAP_EVENT_NOTE_ON : CLAP_EVENT_NOTE_OFF;
+            event->header.flags = 0;
+
+            event->note_id = -1;
+            event->port_index = portIndex;
+            event->channel = static_cast<int16_t>(data[0] & 0x0f);
+            event->key = static_cast<int16_t>(data1);
+            event->velocity = data2 / 127.0;
+        }
+        else if (sendMidi)
+        {
+            auto* event = inputEventQueue.append<clap_event_midi_t>(CLAPEventQueue::NoteLane);
+            if (event == nullptr)
+            {
+                droppedEvents.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            event->header.size = sizeof(clap_event_midi_t);
+            event->header.time = time;
+            event->header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+            event->header.type = CLAP_EVENT_MIDI;
+            event->header.flags = 0;
+
+            event->port_index = static_cast<uint16_t>(portIndex);
+            event->data[0] = data[0];
+            event->data[1] = static_cast<uint8_t>(data1);
+            event->data[2] = static_cast<uint8_t>(data2);
+        }
+        // A CLAP-only note port has no equivalent for the other channel messages
+    }
 }
 
 void CLAPPluginInstance::getState(juce::MemoryBlock& destData)
@@ -846,6 +1284,39 @@ double CLAPPluginInstance::getParameterValue(clap_id paramId) const
     return value;
 }
 
+int CLAPPluginInstance::drainParamEvents(const std::function<void(const CLAPParamEvent&)>& callback)
+{
+    // Nothing processes an inactive plugin, so flush its pending changes here
+    if (flushRequested.exchange(false) && plugin != nullptr && paramsExt != nullptr && !activated)
+    {
+        inputEventQueue.clear();
+        paramsExt->flush(plugin, &inputEvents, &outputEvents);
+    }
+
+    return outputParamEvents.popAll([this, &callback](const CLAPParamEvent& event)
+    {
+        switch (event.type)
+        {
+            case CLAPParamEvent::Value:        reportedParamValues[event.paramId] = event.value; break;
+            case CLAPParamEvent::GestureBegin: activeGestures.insert(event.paramId); break;
+            case CLAPParamEvent::GestureEnd:   activeGestures.erase(event.paramId); break;
+        }
+
+        if (callback)
+            callback(event);
+    });
+}
+
+bool CLAPPluginInstance::getReportedParameterValue(clap_id paramId, double& value) const
+{
+    const auto it = reportedParamValues.find(paramId);
+    if (it == reportedParamValues.end())
+        return false;
+
+    value = it->second;
+    return true;
+}
+
 void CLAPPluginInstance::setParameterValue(clap_id paramId, double value)
 {
     if (!plugin || !paramsExt)
@@ -903,50 +1374,6 @@ std::vector<CLAPParameterInfo> CLAPPluginInstance::getModulatableParameters() co
     return modulatable;
 }
 
-void CLAPPluginInstance::processWithModulation(juce::AudioBuffer<float>& buffer,
-                                                juce::MidiBuffer& midiMessages,
-                                                const std::vector<ModulationEvent>& modEvents)
-{
-    if (!plugin || !activated)
-        return;
-
-    // Build modulation events for this process block
-    pendingModEvents.clear();
-    pendingModEvents.reserve(modEvents.size());
-
-    for (const auto& modEvent : modEvents)
-    {
-        clap_event_param_mod_t event;
-        event.header.size = sizeof(clap_event_param_mod_t);
-        event.header.time = modEvent.sampleOffset;
-        event.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
-        event.header.type = CLAP_EVENT_PARAM_MOD;
-        event.header.flags = 0;
-
-        event.param_id = modEvent.paramId;
-        event.cookie = nullptr;  // Could cache for performance
-        event.note_id = -1;      // Global modulation (not per-note)
-        event.port_index = -1;
-        event.channel = -1;
-        event.key = -1;
-        event.amount = modEvent.amount;
-
-        pendingModEvents.push_back(event);
-    }
-
-    // Sort events by time (CLAP requires this)
-    std::sort(pendingModEvents.begin(), pendingModEvents.end(),
-        [](const clap_event_param_mod_t& a, const clap_event_param_mod_t& b) {
-            return a.header.time < b.header.time;
-        });
-
-    // Now process as normal - the event callbacks will return our modulation events
-    process(buffer, midiMessages);
-
-    // Clear for next block
-    pendingModEvents.clear();
-}
-
 // ============================================================================
 // CLAPEditorWindow - JUCE-based window with POSIX FD polling for CLAP GUI
 // ============================================================================
@@ -1175,8 +1602,12 @@ void CLAPEditorWindow::attachPluginGui()
 // CLAPPluginScanner
 // ============================================================================
 
-void CLAPPluginScanner::scanDefaultLocations()
+bool CLAPPluginScanner::scanDefaultLocations(bool cachedOnly)
 {
+    cachedOnlyScan = cachedOnly && cache != nullptr;
+    uncachedFiles.clear();
+    scannedPaths.clear();
+
     juce::StringArray paths;
 
 #if JUCE_WINDOWS
@@ -1207,7 +1638,16 @@ void CLAPPluginScanner::scanDefaultLocations()
         }
     }
 
-    std::cerr << "[CLAP Scanner] Found " << plugins.size() << " CLAP plugins" << std::endl;
+    // Drop cache entries for files that have been removed
+    if (cache != nullptr)
+    {
+        cache->retainOnly(PluginScanCache::Format::CLAP, scannedPaths);
+        cache->save();
+    }
+
+    std::cerr << "[CLAP Scanner] Found " << plugins.size() << " CLAP plugins"
+              << (uncachedFiles.isEmpty() ? "" : " (cached only, new files pending)") << std::endl;
+    return uncachedFiles.isEmpty();
 }
 
 void CLAPPluginScanner::scanDirectory(const juce::File& directory)
@@ -1239,7 +1679,29 @@ void CLAPPluginScanner::scanFile(const juce::File& clapFile)
         return;
     }
 
+    if (cache == nullptr)
+    {
+        extractPluginsFromFile(clapFile);
+        return;
+    }
+
+    const auto path = clapFile.getFullPathName();
+    const auto stamp = PluginScanCache::stampFor(clapFile);
+    scannedPaths.add(path);
+
+    if (cache->findCLAP(path, stamp, plugins))
+        return;
+
+    if (cachedOnlyScan)
+    {
+        uncachedFiles.add(path);
+        return;
+    }
+
+    // New or changed - load it and remember what it holds (even if nothing)
+    const size_t firstNew = plugins.size();
     extractPluginsFromFile(clapFile);
+    cache->storeCLAP(path, stamp, std::vector<CLAPPluginDescription>(plugins.begin() + static_cast<std::ptrdiff_t>(firstNew), plugins.end()));
 }
 
 void CLAPPluginScanner::extractPluginsFromFile(const juce::File& clapFile)
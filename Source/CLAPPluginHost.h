@@ -4,12 +4,20 @@
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_gui_basics/juce_gui_basics.h>
 #include <clap/clap.h>
+#include <clap/ext/audio-ports-config.h>
+#include <clap/ext/note-ports.h>
 #include <clap/ext/posix-fd-support.h>
+#include <clap/ext/thread-check.h>
 #include <clap/ext/timer-support.h>
+#include "CLAPEventQueue.h"
+#include "CLAPParamEventRing.h"
 #include <memory>
 #include <vector>
 #include <string>
 #include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <type_traits>
 
 #if JUCE_LINUX
     #include <X11/Xlib.h>
@@ -19,6 +27,7 @@
 // Forward declarations
 struct CLAPPluginInstance;
 class CLAPPluginInstance;
+class PluginScanCache;
 
 // JUCE-based window for hosting CLAP plugin GUIs with POSIX FD polling
 class CLAPEditorWindow : public juce::DocumentWindow,
@@ -102,7 +111,71 @@ public:
     void deactivate();
     bool isActive() const { return activated; }
 
-    void process(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages);
+    // Processes buffer in place: channels [0, numMainChannels) feed the main
+    // ports, any channels after them the first aux input port (sidechain).
+    // Sends whatever was appended to the input event queue since the last call,
+    // with midiMessages merged in on the note lane (see addMidiEvents).
+    // constantChannels has a bit set for each buffer channel (of the first 64)
+    // known to hold one value throughout, passed on as constant_mask.
+    // Returns the plugin's status (CLAP_PROCESS_SLEEP etc.) for the host's sleep logic.
+    clap_process_status process(juce::AudioBuffer<float>& buffer, int numMainChannels, juce::MidiBuffer& midiMessages,
+                                uint64_t constantChannels);
+
+    // Same, with 64-bit buffers - only if supportsDoublePrecision()
+    clap_process_status process(juce::AudioBuffer<double>& buffer, int numMainChannels, juce::MidiBuffer& midiMessages,
+                                uint64_t constantChannels);
+
+    // Every audio port accepts 64-bit buffers (CLAP_AUDIO_PORT_SUPPORTS_64BITS).
+    // Known once activated.
+    bool supportsDoublePrecision() const;
+
+    // Main channel count to ask for through audio-ports-config on the next
+    // activate(). 0 keeps the plugin's current configuration.
+    void setPreferredMainChannels(uint32_t numChannels) { preferredMainChannels = numChannels; }
+
+    // Channels of the main output port (0 if it has none). Known once activated.
+    uint32_t getMainOutputChannels() const;
+
+    // Audio thread: send the plugin to sleep (stop_processing) while the host
+    // skips it. The next process() call restarts it.
+    void suspendProcessing();
+
+    // Audio thread: true once after the plugin asked to be processed again
+    // (clap_host::request_process) - the host should wake it even on silent input
+    bool consumeProcessRequest() { return processRequested.exchange(false); }
+
+    // Tail in samples from the CLAP tail extension (re-queried after
+    // clap_host_tail::changed). UINT32_MAX means infinite; plugins without the
+    // extension report infinite. Audio thread.
+    uint32_t getTailSamples();
+
+    // Audio thread: input events for the next process() call. Each lane must be
+    // appended in time order; the queue is cleared after every process().
+    CLAPEventQueue& getInputEventQueue() { return inputEventQueue; }
+
+    // Modulation routes one plugin can take. The modulation lane holds one
+    // event per route for every control point of the largest block.
+    static constexpr int MAX_MODULATION_ROUTES = 128;
+
+    // Message thread, before activate(): modulation events per process() call
+    void setMaxModulationEvents(size_t numEvents) { maxModulationEvents = numEvents; }
+
+    // Append a global CLAP_EVENT_PARAM_MOD to the modulation lane.
+    // cookie is optional (from clap_param_info). Events that don't fit are
+    // dropped and counted.
+    void addModulationEvent(uint32_t sampleOffset, clap_id paramId, void* cookie, double amount);
+
+    // Input events dropped because their lane was full, since the last call (message thread)
+    uint32_t consumeDroppedEvents() { return droppedEvents.exchange(0); }
+
+    // Latency (main thread, plugin active). The plugin reports changes through
+    // clap_host_latency::changed; consumeLatencyChanged() tells the host to re-query.
+    uint32_t getLatencySamples() const;
+    bool consumeLatencyChanged() { return latencyChanged.exchange(false); }
+
+    // clap_host::request_restart (any thread). The host must deactivate and
+    // reactivate the plugin on the main thread, e.g. to apply a new latency.
+    bool consumeRestartRequest() { return restartRequested.exchange(false); }
 
     // State
     void getState(juce::MemoryBlock& destData);
@@ -133,18 +206,28 @@ public:
     // Get only modulatable parameters
     std::vector<CLAPParameterInfo> getModulatableParameters() const;
 
-    // Modulation event for process()
-    struct ModulationEvent
-    {
-        clap_id paramId;
-        double amount;          // Modulation amount (in parameter value units)
-        uint32_t sampleOffset;  // Sample offset within buffer
-    };
+    // Message thread: pass on the parameter events the plugin has sent since
+    // the last call (changes made in its own GUI, gesture begin/end), oldest
+    // first. The value cache and gesture state below are updated before each
+    // event is passed on. Returns how many there were.
+    int drainParamEvents(const std::function<void(const CLAPParamEvent&)>& callback);
+
+    // Last value the plugin reported for paramId through its output events.
+    // False if it hasn't reported one. Message thread.
+    bool getReportedParameterValue(clap_id paramId, double& value) const;
 
-    // Process with modulation events
-    void processWithModulation(juce::AudioBuffer<float>& buffer,
-                               juce::MidiBuffer& midiMessages,
-                               const std::vector<ModulationEvent>& modEvents);
+    // The user is dragging paramId in the plugin's GUI (between gesture begin
+    // and end). Message thread.
+    bool isParameterGestureActive(clap_id paramId) const { return activeGestures.count(paramId) > 0; }
+
+    // Changes whenever parameter cookies may have become invalid (params rescan,
+    // restart request). Cookies fetched under an older generation must not be sent.
+    // Generations come from a process-wide counter, so no two instances ever
+    // share one and a cookie can't pass as another plugin's.
+    uint32_t getCookieGeneration() const { return cookieGeneration.load(); }
+
+    // Unique for the lifetime of the process (never reused, unlike the address)
+    uint64_t getInstanceId() const { return instanceId; }
 
 #if JUCE_LINUX
     // Poll registered FDs and dispatch events (called by CLAPEditorWindow timer)
@@ -170,37 +253,120 @@ private:
     static void hostRequestProcess(const clap_host* host);
     static void hostRequestCallback(const clap_host* host);
 
+    // Host-side params callbacks
+    static void hostParamsRescan(const clap_host* host, clap_param_rescan_flags flags);
+    static void hostParamsClear(const clap_host* host, clap_id paramId, clap_param_clear_flags flags);
+    static void hostParamsRequestFlush(const clap_host* host);
+    static clap_host_params hostParams;
+    std::atomic<uint32_t> cookieGeneration;
+    const uint64_t instanceId;
+    std::atomic<bool> flushRequested{false};  // Inactive plugin: flush from the message thread
+
+    // Parameter events from the plugin, audio thread -> message thread
+    static constexpr int MAX_OUTPUT_PARAM_EVENTS = 4096;  // A quarter second of dense GUI automation
+    CLAPParamEventRing outputParamEvents;
+    std::unordered_map<clap_id, double> reportedParamValues;  // Message thread
+    std::unordered_set<clap_id> activeGestures;               // Message thread
+
+    // Host-side latency callback
+    static void hostLatencyChanged(const clap_host* host);
+    static clap_host_latency hostLatency;
+    std::atomic<bool> latencyChanged{false};
+    std::atomic<bool> restartRequested{false};
+
+    // Host-side thread check: the message thread is CLAP's main thread; the
+    // audio thread and the worker pool's threads (while running slots) are
+    // audio threads
+    static bool hostIsMainThread(const clap_host* host);
+    static bool hostIsAudioThread(const clap_host* host);
+    static clap_host_thread_check hostThreadCheck;
+
+    // Host-side tail callback
+    static void hostTailChanged(const clap_host* host);
+    static clap_host_tail hostTail;
+    std::atomic<bool> tailChanged{true};
+    uint32_t tailSamples = 0;  // Audio thread cache
+
+    // Sleep support: processing is stopped while the host skips the plugin
+    std::atomic<bool> processingStarted{false};
+    std::atomic<bool> processRequested{false};
+
     // State
     bool activated = false;
     double currentSampleRate = 44100.0;
     uint32_t currentBlockSize = 512;
 
+    // Port configuration picked by activate() (audio-ports-config)
+    uint32_t preferredMainChannels = 0;
+    void selectPortsConfig();
+
     // Audio port info - per-port channel counts
     struct AudioPortInfo {
         uint32_t channelCount = 0;
         bool isMain = false;
+        bool supports64 = false;
     };
     std::vector<AudioPortInfo> inputPorts;
     std::vector<AudioPortInfo> outputPorts;
     uint32_t totalInputChannels = 0;
     uint32_t totalOutputChannels = 0;
 
-    // Process buffers - organized per port (CLAP requires this)
-    std::vector<std::vector<float*>> inputPortBuffers;   // [port][channel]
-    std::vector<std::vector<float*>> outputPortBuffers;  // [port][channel]
+    // Note input port the host's MIDI goes to (-1 if the plugin takes none),
+    // the dialects it accepts, and whether notes go as CLAP note events
+    // (otherwise everything is sent as raw MIDI). Set in activate().
+    int noteInputPort = -1;
+    uint32_t noteInputDialects = 0;
+    bool sendClapNotes = false;
+
+    // Process buffers - organized per port (CLAP requires this), one set per
+    // sample type. The 64-bit set is only allocated if the plugin supports it.
+    template <typename SampleType>
+    struct PortBuffers
+    {
+        std::vector<std::vector<SampleType*>> inputs;   // [port][channel]
+        std::vector<std::vector<SampleType*>> outputs;  // [port][channel]
+
+        // Sized in activate(): one zeroed channel shared by every silent input
+        // (sidechain when not connected), and a discard channel per unmapped output
+        juce::AudioBuffer<SampleType> silent;
+        juce::AudioBuffer<SampleType> auxOutput;
+    };
+    PortBuffers<float> portBuffers32;
+    PortBuffers<double> portBuffers64;
+
+    template <typename SampleType>
+    PortBuffers<SampleType>& getPortBuffers()
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return portBuffers64;
+        else
+            return portBuffers32;
+    }
+
+    template <typename SampleType>
+    void preparePortBuffers(PortBuffers<SampleType>& buffers, uint32_t maxFrameCount);
+
+    template <typename SampleType>
+    clap_process_status processBuffer(juce::AudioBuffer<SampleType>& buffer, int numMainChannels, uint64_t constantChannels);
+
+    // Audio thread: translate channel messages into sample-stamped note/MIDI
+    // events on the note lane. Reads the raw bytes, so it never allocates;
+    // SysEx and system messages are dropped, and so is MIDI once the lane is full.
+    void addMidiEvents(const juce::MidiBuffer& midiMessages, int numSamples);
+
     std::vector<clap_audio_buffer> inputAudioBuffers;    // One per input port
     std::vector<clap_audio_buffer> outputAudioBuffers;   // One per output port
     clap_process processContext;
 
-    // Scratch buffer for silent channels (sidechain when not connected)
-    juce::AudioBuffer<float> scratchBuffer;
-
     // Event queues (required by CLAP process)
     clap_input_events inputEvents;
     clap_output_events outputEvents;
 
-    // Dynamic event storage for modulation
-    std::vector<clap_event_param_mod_t> pendingModEvents;
+    // Input events, preallocated in activate()
+    static constexpr size_t MAX_NOTE_EVENTS = 2048;
+    size_t maxModulationEvents = 2048;
+    CLAPEventQueue inputEventQueue;
+    std::atomic<uint32_t> droppedEvents{0};
 
     // Static callbacks for event queues
     static uint32_t inputEventsSize(const clap_input_events* list);
@@ -251,13 +417,18 @@ private:
 
     // Extensions cache
     const clap_plugin_audio_ports* audioPortsExt = nullptr;
+    const clap_plugin_audio_ports_config* audioPortsConfigExt = nullptr;
     const clap_plugin_params* paramsExt = nullptr;
     const clap_plugin_state* stateExt = nullptr;
     const clap_plugin_gui* guiExt = nullptr;
+    const clap_plugin_latency* latencyExt = nullptr;
+    const clap_plugin_tail* tailExt = nullptr;
+    const clap_plugin_note_ports* notePortsExt = nullptr;
 
     void initHost();
     bool queryExtensions();
     bool setupAudioPorts();
+    void setupNotePorts();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CLAPPluginInstance)
 };
@@ -268,8 +439,16 @@ class CLAPPluginScanner
 public:
     CLAPPluginScanner() = default;
 
-    // Scan for CLAP plugins in standard locations
-    void scanDefaultLocations();
+    // Serve unchanged .clap files from this cache instead of loading them
+    // (nullptr to always load). Results for loaded files are stored back.
+    void setCache(PluginScanCache* newCache) { cache = newCache; }
+
+    // Scan for CLAP plugins in standard locations. With cachedOnly, files that
+    // aren't in the cache are skipped - returns false if any were.
+    bool scanDefaultLocations(bool cachedOnly = false);
+
+    // Files skipped by the last cached-only scan
+    const juce::StringArray& getUncachedFiles() const { return uncachedFiles; }
 
     // Scan a specific directory
     void scanDirectory(const juce::File& directory);
@@ -289,6 +468,11 @@ public:
 private:
     std::vector<CLAPPluginDescription> plugins;
 
+    PluginScanCache* cache = nullptr;
+    bool cachedOnlyScan = false;
+    juce::StringArray uncachedFiles;
+    juce::StringArray scannedPaths;  // Every file seen by the current scan
+
     void extractPluginsFromFile(const juce::File& clapFile);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CLAPPluginScanner)
@@ -0,0 +1,159 @@
+#include "ChainStateFormat.h"
+
+bool ChainStateFormat::isBinaryState(const void* data, size_t size)
+{
+    return data != nullptr && size >= HEADER_BYTES
+        && juce::ByteOrder::littleEndianInt(data) == MAGIC;
+}
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+void ChainStateFormat::Writer::addChunk(ChunkType type, int slot, const void* data, size_t size)
+{
+    Chunk chunk { type, slot, 0, static_cast<juce::uint64>(size), {} };
+
+    if (size >= MIN_COMPRESS_BYTES)
+    {
+        {
+            juce::MemoryOutputStream compressed(chunk.data, false);
+            juce::GZIPCompressorOutputStream deflater(compressed, COMPRESSION_LEVEL);
+            deflater.write(data, size);
+        }
+
+        // The streams have flushed and trimmed chunk.data to the deflated size
+        if (chunk.data.getSize() < size)
+            chunk.flags = FLAG_DEFLATE;
+    }
+
+    if (chunk.flags == 0)
+        chunk.data.replaceAll(data, size);
+
+    chunks.push_back(std::move(chunk));
+}
+
+void ChainStateFormat::Writer::writeTo(juce::MemoryBlock& dest) const
+{
+    size_t payloadSize = 0;
+    for (const auto& chunk : chunks)
+        payloadSize += chunk.data.getSize();
+
+    juce::MemoryOutputStream out(dest, false);
+    out.preallocate(HEADER_BYTES + INDEX_ENTRY_BYTES * chunks.size() + payloadSize);
+
+    out.writeInt(static_cast<int>(MAGIC));
+    out.writeInt(static_cast<int>(FORMAT_VERSION));
+    out.writeInt(static_cast<int>(chunks.size()));
+
+    juce::uint64 offset = 0;
+    for (const auto& chunk : chunks)
+    {
+        out.writeInt(static_cast<int>(chunk.type));
+        out.writeInt(chunk.slot);
+        out.writeInt(static_cast<int>(chunk.flags));
+        out.writeInt64(static_cast<juce::int64>(offset));
+        out.writeInt64(static_cast<juce::int64>(chunk.data.getSize()));
+        out.writeInt64(static_cast<juce::int64>(chunk.rawSize));
+        offset += chunk.data.getSize();
+    }
+
+    for (const auto& chunk : chunks)
+        out.write(chunk.data.getData(), chunk.data.getSize());
+
+    out.flush();
+}
+
+// ============================================================================
+// Reader
+// ============================================================================
+
+bool ChainStateFormat::Reader::open(const void* data, size_t size)
+{
+    index.clear();
+    payload = nullptr;
+
+    if (!isBinaryState(data, size))
+        return false;
+
+    juce::MemoryInputStream in(data, size, false);
+    in.readInt();  // Magic
+
+    if (static_cast<juce::uint32>(in.readInt()) > FORMAT_VERSION)
+        return false;  // Written by a newer wrapper
+
+    const auto numChunks = static_cast<juce::uint32>(in.readInt());
+    if (numChunks > (size - HEADER_BYTES) / INDEX_ENTRY_BYTES)
+        return false;
+
+    const auto payloadOffset = HEADER_BYTES + INDEX_ENTRY_BYTES * numChunks;
+    const auto payloadSize = static_cast<juce::uint64>(size - payloadOffset);
+
+    for (juce::uint32 i = 0; i < numChunks; ++i)
+    {
+        IndexEntry entry;
+        entry.type = static_cast<juce::uint32>(in.readInt());
+        entry.slot = in.readInt();
+        entry.flags = static_cast<juce::uint32>(in.readInt());
+        entry.offset = static_cast<juce::uint64>(in.readInt64());
+        entry.storedSize = static_cast<juce::uint64>(in.readInt64());
+        entry.rawSize = static_cast<juce::uint64>(in.readInt64());
+
+        if (entry.offset > payloadSize || entry.storedSize > payloadSize - entry.offset)
+            return false;
+
+        // Raw chunks are exactly their stored size; deflated ones are capped
+        // before anything is allocated for them
+        if ((entry.flags & FLAG_DEFLATE) == 0 ? entry.rawSize != entry.storedSize
+                                              : entry.rawSize > MAX_RAW_BYTES
+                                                    || entry.rawSize > entry.storedSize * MAX_INFLATE_RATIO)
+            return false;
+
+        index.push_back(entry);
+    }
+
+    payload = static_cast<const char*>(data) + payloadOffset;
+    return true;
+}
+
+bool ChainStateFormat::Reader::readChunk(ChunkType type, int slot, juce::MemoryBlock& dest) const
+{
+    for (const auto& entry : index)
+    {
+        if (entry.type != static_cast<juce::uint32>(type) || entry.slot != slot)
+            continue;
+
+        const auto* stored = payload + entry.offset;
+        const auto storedSize = static_cast<size_t>(entry.storedSize);
+
+        if ((entry.flags & FLAG_DEFLATE) == 0)
+        {
+            dest.replaceAll(stored, storedSize);
+            return true;
+        }
+
+        juce::MemoryInputStream compressed(stored, storedSize, false);
+        juce::GZIPDecompressorInputStream inflater(compressed);
+
+        // Bounded by open(); read in int-sized pieces all the same
+        constexpr size_t MAX_READ = 1 << 24;
+        const auto rawSize = static_cast<size_t>(entry.rawSize);
+        dest.setSize(rawSize);
+
+        size_t total = 0;
+        while (total < rawSize)
+        {
+            const auto wanted = static_cast<int>(juce::jmin(MAX_READ, rawSize - total));
+            const int numRead = inflater.read(static_cast<char*>(dest.getData()) + total, wanted);
+            if (numRead <= 0)
+                return false;  // Truncated
+            total += static_cast<size_t>(numRead);
+        }
+
+        // Nothing may follow the declared size
+        char extra;
+        return inflater.read(&extra, 1) <= 0;
+    }
+
+    return false;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <vector>
+
+// Binary container for the wrapper state (state version 5). Replaces the
+// version 4 format, which base64-encoded every plugin state into an XML tree.
+//
+// Layout (all integers little-endian):
+//
+//     Header   magic "UHBS" | uint32 version | uint32 numChunks
+//     Index    numChunks x { uint32 type | int32 slot | uint32 flags |
+//                            uint64 offset | uint64 storedSize | uint64 rawSize }
+//     Payload  chunk data, offsets relative to the start of the payload
+//
+// The index allows any chunk to be located and decoded on its own. Chunks of
+// MIN_COMPRESS_BYTES or more are deflated when that makes them smaller
+// (flags & FLAG_DEFLATE); everything else is stored raw.
+class ChainStateFormat
+{
+public:
+    static constexpr juce::uint32 FORMAT_VERSION = 1;
+    static constexpr size_t MIN_COMPRESS_BYTES = 4096;
+    static constexpr int COMPRESSION_LEVEL = 1;  // Fastest - this runs on every host autosave
+
+    // Sizes read from saved data are untrusted. A chunk may not claim to
+    // inflate past MAX_RAW_BYTES, nor to more than MAX_INFLATE_RATIO times its
+    // stored size (deflate tops out near 1032:1).
+    static constexpr juce::uint64 MAX_RAW_BYTES = juce::uint64(1) << 30;
+    static constexpr juce::uint64 MAX_INFLATE_RATIO = 1032;
+
+    enum ChunkType : juce::uint32
+    {
+        settingsChunk = 0x53544553,  // "SETS" - the EffectChainState ValueTree
+        pluginChunk = 0x47554c50     // "PLUG" - one hosted plugin's state blob
+    };
+
+    static constexpr juce::uint32 FLAG_DEFLATE = 1;
+
+    // True if data starts with the binary format's magic
+    static bool isBinaryState(const void* data, size_t size);
+
+    class Writer
+    {
+    public:
+        // Copies the data. slot is -1 for chunks not tied to a slot.
+        void addChunk(ChunkType type, int slot, const void* data, size_t size);
+        void writeTo(juce::MemoryBlock& dest) const;
+
+    private:
+        struct Chunk
+        {
+            ChunkType type;
+            int slot;
+            juce::uint32 flags;
+            juce::uint64 rawSize;
+            juce::MemoryBlock data;  // As stored
+        };
+
+        std::vector<Chunk> chunks;
+    };
+
+    class Reader
+    {
+    public:
+        // Validates the header and index against size. The data must outlive the reader.
+        bool open(const void* data, size_t size);
+
+        // Decode one chunk into dest. Returns false if there is no such chunk
+        // or it is corrupt.
+        bool readChunk(ChunkType type, int slot, juce::MemoryBlock& dest) const;
+
+    private:
+        struct IndexEntry
+        {
+            juce::uint32 type = 0;
+            int slot = -1;
+            juce::uint32 flags = 0;
+            juce::uint64 offset = 0;
+            juce::uint64 storedSize = 0;
+            juce::uint64 rawSize = 0;
+        };
+
+        const char* payload = nullptr;
+        std::vector<IndexEntry> index;
+    };
+
+private:
+    static constexpr juce::uint32 MAGIC = 0x53424855;  // "UHBS"
+    static constexpr size_t HEADER_BYTES = 12;
+    static constexpr size_t INDEX_ENTRY_BYTES = 36;
+};
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "SamplePrecision.h"
+
+// Fixed-capacity multichannel delay line used for plugin delay compensation.
+// Dry signals are pushed through it so they line up with the output of latent
+// plugins. The capacity is allocated in prepare() (message thread), in the
+// processing precision; the delay can then change freely on the audio thread
+// without allocating.
+class CompensationDelay
+{
+public:
+    static constexpr int SLOT_CAPACITY = 1 << 15;    // ~680 ms at 48 kHz
+    static constexpr int MASTER_CAPACITY = 1 << 17;  // ~2.7 s at 48 kHz
+
+    // capacity must be a power of two; it grows if the block size doesn't fit
+    void prepare(int numChannels, int capacity, int maxBlockSize, bool doublePrecision)
+    {
+        jassert(juce::isPowerOfTwo(capacity));
+        while (capacity <= maxBlockSize)
+            capacity *= 2;
+
+        ring.setSize(numChannels, capacity, doublePrecision);
+        ring.clear();
+        mask = capacity - 1;
+        maxDelay = capacity - maxBlockSize;
+        writePos = 0;
+    }
+
+    void reset()
+    {
+        ring.clear();
+        writePos = 0;
+    }
+
+    int getMaxDelay() const { return maxDelay; }
+
+    // Write numSamples of input into the line and read the signal from
+    // delaySamples ago into output. input and output may be the same buffer.
+    // SampleType must match the precision given to prepare().
+    template <typename SampleType>
+    void process(const juce::AudioBuffer<SampleType>& input, juce::AudioBuffer<SampleType>& output,
+                 int numChannels, int numSamples, int delaySamples)
+    {
+        auto& lines = ring.get<SampleType>();
+        const int capacity = lines.getNumSamples();
+        if (capacity == 0)
+            return;
+
+        numChannels = juce::jmin(numChannels, lines.getNumChannels(), input.getNumChannels(), output.getNumChannels());
+        delaySamples = juce::jlimit(0, maxDelay, delaySamples);
+
+        const int readPos = (writePos - delaySamples) & mask;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            SampleType* line = lines.getWritePointer(ch);
+
+            // Write (in at most two segments around the wrap point)
+            const SampleType* in = input.getReadPointer(ch);
+            const int firstWrite = juce::jmin(numSamples, capacity - writePos);
+            juce::FloatVectorOperations::copy(line + writePos, in, firstWrite);
+            juce::FloatVectorOperations::copy(line, in + firstWrite, numSamples - firstWrite);
+
+            // Read
+            SampleType* out = output.getWritePointer(ch);
+            const int firstRead = juce::jmin(numSamples, capacity - readPos);
+            juce::FloatVectorOperations::copy(out, line + readPos, firstRead);
+            juce::FloatVectorOperations::copy(out + firstRead, line, numSamples - firstRead);
+        }
+
+        writePos = (writePos + numSamples) & mask;
+    }
+
+private:
+    DualPrecisionBuffer ring;
+    int mask = 0;
+    int maxDelay = 0;
+    int writePos = 0;
+};
+
+// One-block FIFO between two pipeline stages. The producer writes block N
+// while the consumer reads what was written exactly blockSize samples earlier,
+// so both can run at the same time on different threads (blocks are never
+// longer than blockSize, so the regions never overlap). advance() is called
+// once both sides have finished the block.
+class PipelineFifo
+{
+public:
+    void prepare(int numChannels, int blockSize, bool doublePrecision)
+    {
+        const int capacity = juce::nextPowerOfTwo(blockSize * 2);
+        ring.setSize(numChannels, capacity, doublePrecision);
+        ring.clear();
+        mask = capacity - 1;
+        delay = blockSize;
+        position = 0;
+    }
+
+    void reset()
+    {
+        ring.clear();
+        position = 0;
+    }
+
+    // Producer side. SampleType must match the precision given to prepare().
+    template <typename SampleType>
+    void write(const juce::AudioBuffer<SampleType>& input, int numSamples)
+    {
+        auto& lines = ring.get<SampleType>();
+        const int capacity = lines.getNumSamples();
+        const int numChannels = juce::jmin(lines.getNumChannels(), input.getNumChannels());
+        jassert(numSamples <= delay);
+
+        const int first = juce::jmin(numSamples, capacity - position);
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            SampleType* line = lines.getWritePointer(ch);
+            const SampleType* in = input.getReadPointer(ch);
+            juce::FloatVectorOperations::copy(line + position, in, first);
+            juce::FloatVectorOperations::copy(line, in + first, numSamples - first);
+        }
+    }
+
+    // Consumer side - the signal from blockSize samples before the current block
+    template <typename SampleType>
+    void read(juce::AudioBuffer<SampleType>& output, int numSamples)
+    {
+        const auto& lines = ring.get<SampleType>();
+        const int capacity = lines.getNumSamples();
+        const int numChannels = juce::jmin(lines.getNumChannels(), output.getNumChannels());
+        jassert(numSamples <= delay);
+
+        const int start = (position - delay) & mask;
+        const int first = juce::jmin(numSamples, capacity - start);
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const SampleType* line = lines.getReadPointer(ch);
+            SampleType* out = output.getWritePointer(ch);
+            juce::FloatVectorOperations::copy(out, line + start, first);
+            juce::FloatVectorOperations::copy(out + first, line, numSamples - first);
+        }
+    }
+
+    void advance(int numSamples) { position = (position + numSamples) & mask; }
+
+private:
+    DualPrecisionBuffer ring;
+    int mask = 0;
+    int delay = 0;
+    int position = 0;
+};
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+#include "DelayCompensation.h"
+
+// Sidechain-triggered ducker. Works a block at a time: the sidechain detector
+// is computed for the whole block with vector ops, a short serial loop turns it
+// into a gain curve (attack / hold / release follower), and the curve is applied
+// to the main channels with a vector multiply. Envelope coefficients are only
+// recomputed when the attack, release or hold time actually changes.
+//
+// With lookahead the main path is delayed while the detector keeps running on
+// the undelayed sidechain, so gain reduction is already in place when a
+// transient arrives. The delay is reported to the host as latency.
+//
+// The main path runs in the processing precision (float or double); the
+// detector and follower always work in float.
+class Ducker
+{
+public:
+    enum class Detector
+    {
+        Peak,  // max(|L|, |R|) per sample
+        Rms    // Mean square of the peak detector over RMS_WINDOW_MS
+    };
+
+    static constexpr float RMS_WINDOW_MS = 10.0f;
+    static constexpr float MAX_LOOKAHEAD_MS = 20.0f;
+
+    Ducker() = default;
+
+    // Message thread - sizes the work buffers and lookahead line, resets the follower
+    void prepare(double newSampleRate, int maxBlockSize, int numMainChannels, bool doublePrecision)
+    {
+        sampleRate = newSampleRate;
+        capacity = juce::jmax(1, maxBlockSize);
+        detectorBuffer.assign(static_cast<size_t>(capacity), 0.0f);
+        gainBuffer.assign(static_cast<size_t>(capacity), 0.0f);
+        gainBuffer64.assign(doublePrecision ? static_cast<size_t>(capacity) : 0, 0.0);
+
+        const int maxLookahead = lookaheadMsToSamples(MAX_LOOKAHEAD_MS);
+        lookaheadDelay.prepare(juce::jmax(1, numMainChannels), juce::nextPowerOfTwo(maxLookahead + capacity), capacity,
+                               doublePrecision);
+        lookaheadActive = false;
+
+        // Force the coefficients to be recomputed for the new rate
+        cachedAttackMs = cachedReleaseMs = cachedHoldMs = -1.0f;
+        rmsCoef = std::exp(-1.0f / (static_cast<float>(sampleRate) * RMS_WINDOW_MS * 0.001f));
+        reset();
+    }
+
+    void reset()
+    {
+        envelope = 0.0f;
+        holdCounter = 0.0f;
+        meanSquare = 0.0f;
+    }
+
+    // Audio thread - cheap to call every block
+    void setParameters(float thresholdDb, float amountPercent, float attackMs, float releaseMs, float holdMs)
+    {
+        thresholdGain = juce::Decibels::decibelsToGain(thresholdDb);
+        amount = amountPercent / 100.0f;
+
+        if (attackMs != cachedAttackMs || releaseMs != cachedReleaseMs || holdMs != cachedHoldMs)
+        {
+            const float samplesPerMs = static_cast<float>(sampleRate) * 0.001f;
+            attackCoef = std::exp(-1.0f / (samplesPerMs * attackMs));
+            releaseCoef = std::exp(-1.0f / (samplesPerMs * releaseMs));
+            holdSamples = samplesPerMs * holdMs;
+
+            cachedAttackMs = attackMs;
+            cachedReleaseMs = releaseMs;
+            cachedHoldMs = holdMs;
+        }
+    }
+
+    void setDetector(Detector newDetector) { detector = newDetector; }
+
+    // Audio thread - main path delay in samples (0 = off)
+    void setLookahead(int samples) { lookaheadSamples = juce::jlimit(0, lookaheadDelay.getMaxDelay(), samples); }
+
+    // Audio thread - call on blocks where process() is skipped, so the lookahead
+    // line doesn't replay stale audio when the ducker comes back
+    void bypassed() { lookaheadActive = false; }
+
+    int lookaheadMsToSamples(float ms) const
+    {
+        return juce::roundToInt(sampleRate * 0.001 * juce::jlimit(0.0f, MAX_LOOKAHEAD_MS, ms));
+    }
+
+    // Duck numMainChannels of main in place, keyed by the sidechain. sidechainRight
+    // may be nullptr for a mono key, and sidechainLeft nullptr for no key at all
+    // (the envelope just releases). Returns the current gain reduction (0-1).
+    // SampleType must match the precision given to prepare().
+    template <typename SampleType>
+    float process(SampleType* const* main, int numMainChannels, const SampleType* sidechainLeft,
+                  const SampleType* sidechainRight, int numSamples)
+    {
+        if (capacity == 0)
+            return 0.0f;
+
+        if (lookaheadSamples > 0)
+        {
+            // Coming back from bypass or zero lookahead: start from silence
+            if (!lookaheadActive)
+                lookaheadDelay.reset();
+            lookaheadActive = true;
+
+            juce::AudioBuffer<SampleType> mainBuffer(main, numMainChannels, numSamples);
+            lookaheadDelay.process(mainBuffer, mainBuffer, numMainChannels, numSamples, lookaheadSamples);
+        }
+        else
+        {
+            lookaheadActive = false;
+        }
+
+        for (int offset = 0; offset < numSamples; offset += capacity)
+        {
+            const int n = juce::jmin(capacity, numSamples - offset);
+            processSegment(main, numMainChannels,
+                           sidechainLeft != nullptr ? sidechainLeft + offset : nullptr,
+                           sidechainRight != nullptr ? sidechainRight + offset : nullptr, offset, n);
+        }
+
+        // Don't let the release tail run into denormals
+        if (envelope < 1.0e-6f)
+            envelope = 0.0f;
+
+        return envelope * amount;
+    }
+
+private:
+    // |key| into dest, converting a double key to float first
+    static void rectify(float* dest, const float* key, int numSamples)
+    {
+        juce::FloatVectorOperations::abs(dest, key, numSamples);
+    }
+
+    static void rectify(float* dest, const double* key, int numSamples)
+    {
+        SampleConversion::convert(dest, key, numSamples);
+        juce::FloatVectorOperations::abs(dest, dest, numSamples);
+    }
+
+    template <typename SampleType>
+    void processSegment(SampleType* const* main, int numMainChannels, const SampleType* sidechainLeft,
+                        const SampleType* sidechainRight, int offset, int numSamples)
+    {
+        float* level = detectorBuffer.data();
+        float* gain = gainBuffer.data();
+
+        // Detector: max(|L|, |R|) for the whole segment
+        if (sidechainLeft == nullptr)
+            juce::FloatVectorOperations::clear(level, numSamples);
+        else
+            rectify(level, sidechainLeft, numSamples);
+
+        if (sidechainLeft != nullptr && sidechainRight != nullptr)
+        {
+            rectify(gain, sidechainRight, numSamples);
+            juce::FloatVectorOperations::max(level, level, gain, numSamples);
+        }
+
+        if (detector == Detector::Rms)
+        {
+            juce::FloatVectorOperations::multiply(level, level, numSamples);
+            runFollower<true>(level, gain, thresholdGain * thresholdGain, numSamples);
+        }
+        else
+        {
+            // Idle and quiet: the envelope stays at zero and there's nothing to apply
+            if (envelope == 0.0f && holdCounter <= 0.0f
+                && juce::FloatVectorOperations::findMaximum(level, numSamples) <= thresholdGain)
+                return;
+
+            runFollower<false>(level, gain, thresholdGain, numSamples);
+        }
+
+        // Gain curve = 1 - envelope * amount, applied to the main channels
+        juce::FloatVectorOperations::multiply(gain, -amount, numSamples);
+        juce::FloatVectorOperations::add(gain, 1.0f, numSamples);
+
+        if constexpr (std::is_same_v<SampleType, double>)
+        {
+            double* gain64 = gainBuffer64.data();
+            SampleConversion::convert(gain64, gain, numSamples);
+            for (int ch = 0; ch < numMainChannels; ++ch)
+                juce::FloatVectorOperations::multiply(main[ch] + offset, gain64, numSamples);
+        }
+        else
+        {
+            for (int ch = 0; ch < numMainChannels; ++ch)
+                juce::FloatVectorOperations::multiply(main[ch] + offset, gain, numSamples);
+        }
+    }
+
+    // The only serial part: writes the envelope for each sample into envelopeOut
+    template <bool useRms>
+    void runFollower(const float* level, float* envelopeOut, float threshold, int numSamples)
+    {
+        float env = envelope;
+        float hold = holdCounter;
+        float ms = meanSquare;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            float key = level[i];
+            if constexpr (useRms)
+            {
+                ms = rmsCoef * ms + (1.0f - rmsCoef) * key;
+                key = ms;
+            }
+
+            if (key > threshold)
+            {
+                // Attack towards 1 and restart the hold
+                env = attackCoef * env + (1.0f - attackCoef);
+                hold = holdSamples;
+            }
+            else if (hold > 0.0f)
+            {
+                hold -= 1.0f;
+            }
+            else
+            {
+                // Release towards 0
+                env *= releaseCoef;
+            }
+
+            envelopeOut[i] = env;
+        }
+
+        envelope = env;
+        holdCounter = hold;
+        meanSquare = ms;
+    }
+
+    double sampleRate = 44100.0;
+    int capacity = 0;
+    std::vector<float> detectorBuffer;
+    std::vector<float> gainBuffer;
+    std::vector<double> gainBuffer64;  // Double precision only: the gain curve for the main path
+
+    Detector detector = Detector::Peak;
+    float thresholdGain = 0.1f;
+    float amount = 0.5f;
+
+    // Cached coefficients
+    float cachedAttackMs = -1.0f;
+    float cachedReleaseMs = -1.0f;
+    float cachedHoldMs = -1.0f;
+    float attackCoef = 0.0f;
+    float releaseCoef = 0.0f;
+    float holdSamples = 0.0f;
+    float rmsCoef = 0.0f;
+
+    // Lookahead
+    CompensationDelay lookaheadDelay;
+    int lookaheadSamples = 0;
+    bool lookaheadActive = false;
+
+    // Follower state
+    float envelope = 0.0f;
+    float holdCounter = 0.0f;
+    float meanSquare = 0.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Ducker)
+};
@@ -34,6 +34,13 @@ EffectSlotComponent::EffectSlotComponent(int index, const juce::String& name, bo
     updateBypassButtonColour();
     addAndMakeVisible(bypassButton);
 
+    // Parallel toggle - runs this effect alongside the one above instead of after it
+    parallelButton.addListener(this);
+    parallelButton.setColour(juce::TextButton::textColourOnId, juce::Colours::white);
+    parallelButton.setColour(juce::TextButton::textColourOffId, juce::Colours::white);
+    setParallel(false, index > 0);
+    addAndMakeVisible(parallelButton);
+
     removeButton.addListener(this);
     removeButton.setColour(juce::TextButton::buttonColourId, juce::Colour(0xffaa3333));
     removeButton.setColour(juce::TextButton::textColourOnId, juce::Colours::white);
@@ -98,6 +105,7 @@ EffectSlotComponent::~EffectSlotComponent()
     downButton.removeListener(this);
     editButton.removeListener(this);
     bypassButton.removeListener(this);
+    parallelButton.removeListener(this);
     removeButton.removeListener(this);
     inputGainSlider.removeListener(this);
     outputGainSlider.removeListener(this);
@@ -126,8 +134,9 @@ void EffectSlotComponent::paint(juce::Graphics& g)
     g.setColour(juce::Colour(0xff4a4a4a));
     g.drawHorizontalLine(1, 2.0f, static_cast<float>(bounds.getWidth() - 2));
 
-    // Left status bar (orange when active, grey when bypassed)
-    g.setColour(isBypassed ? juce::Colour(0xff555555) : juce::Colour(0xffff7700));
+    // Left status bar (orange when active, blue when parallel, grey when bypassed, yellow while loading)
+    g.setColour(loading ? juce::Colour(0xffddcc33)
+                : isBypassed ? juce::Colour(0xff555555) : isParallel ? juce::Colour(0xff4488cc) : juce::Colour(0xffff7700));
     g.fillRoundedRectangle(2.0f, 4.0f, 6.0f, static_cast<float>(bounds.getHeight() - 8), 2.0f);
 
     // Border
@@ -179,12 +188,13 @@ void EffectSlotComponent::resized()
     auto buttonWidth = 40;
     auto buttonHeight = 24;
 
-    // Buttons on the right (Edit, Bypass, Remove)
-    auto buttonArea = bounds.removeFromRight(buttonWidth * 3 + 8);
+    // Buttons on the right (Edit, Bypass, Parallel, Remove)
+    auto buttonArea = bounds.removeFromRight(buttonWidth * 4 + 10);
     int buttonY = (bounds.getHeight() - buttonHeight) / 2;
     editButton.setBounds(buttonArea.getX(), buttonY, buttonWidth, buttonHeight);
     bypassButton.setBounds(buttonArea.getX() + buttonWidth + 2, buttonY, buttonWidth, buttonHeight);
-    removeButton.setBounds(buttonArea.getX() + buttonWidth * 2 + 4, buttonY, buttonWidth, buttonHeight);
+    parallelButton.setBounds(buttonArea.getX() + buttonWidth * 2 + 4, buttonY, buttonWidth, buttonHeight);
+    removeButton.setBounds(buttonArea.getX() + buttonWidth * 3 + 6, buttonY, buttonWidth, buttonHeight);
 
     // Knobs area (3 knobs with labels)
     auto knobSize = 36;
@@ -220,6 +230,10 @@ void EffectSlotComponent::buttonClicked(juce::Button* button)
     {
         listener->effectSlotBypassClicked(slotIndex);
     }
+    else if (button == &parallelButton)
+    {
+        listener->effectSlotParallelClicked(slotIndex);
+    }
     else if (button == &removeButton)
     {
         listener->effectSlotRemoveClicked(slotIndex);
@@ -247,10 +261,30 @@ void EffectSlotComponent::setBypassed(bool bypassed)
     repaint();
 }
 
+void EffectSlotComponent::setParallel(bool parallelWithPrevious, bool canBeParallel)
+{
+    isParallel = parallelWithPrevious && canBeParallel;
+    parallelButton.setEnabled(canBeParallel);
+    parallelButton.setColour(juce::TextButton::buttonColourId,
+                             isParallel ? juce::Colour(0xff4488cc) : juce::Colour(0xff555555));
+    repaint();
+}
+
 void EffectSlotComponent::setPluginName(const juce::String& name)
 {
     pluginName = name;
-    nameLabel.setText(pluginName, juce::dontSendNotification);
+    nameLabel.setText(loading ? pluginName + " (Loading...)" : pluginName, juce::dontSendNotification);
+}
+
+void EffectSlotComponent::setLoading(bool isLoading)
+{
+    loading = isLoading;
+    nameLabel.setText(loading ? pluginName + " (Loading...)" : pluginName, juce::dontSendNotification);
+    nameLabel.setColour(juce::Label::textColourId, loading ? juce::Colour(0xffaaaaaa) : juce::Colours::white);
+
+    // Nothing to open yet - the slot can still be moved, bypassed or removed
+    editButton.setEnabled(!loading);
+    repaint();
 }
 
 void EffectSlotComponent::sliderValueChanged(juce::Slider* slider)
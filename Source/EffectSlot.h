@@ -14,6 +14,7 @@ public:
         virtual ~Listener() = default;
         virtual void effectSlotEditClicked(int slotIndex) = 0;
         virtual void effectSlotBypassClicked(int slotIndex) = 0;
+        virtual void effectSlotParallelClicked(int slotIndex) = 0;
         virtual void effectSlotRemoveClicked(int slotIndex) = 0;
         virtual void effectSlotMoveUpClicked(int slotIndex) = 0;
         virtual void effectSlotMoveDownClicked(int slotIndex) = 0;
@@ -36,6 +37,8 @@ public:
     void setBypassed(bool bypassed);
     void setPluginName(const juce::String& name);
     void updateBypassButtonColour();
+    void setParallel(bool parallelWithPrevious, bool canBeParallel);
+    void setLoading(bool isLoading);
     void setCanMove(bool up, bool down);
     void setMixValues(float inputGainDb, float outputGainDb, float mixPercent);
     void setLevels(float inL, float inR, float outL, float outR);
@@ -49,12 +52,15 @@ private:
     int slotIndex;
     juce::String pluginName;
     bool isBypassed;
+    bool isParallel = false;
+    bool loading = false;
 
     juce::Label nameLabel;
     juce::TextButton upButton{"^"};
     juce::TextButton downButton{"v"};
     juce::TextButton editButton{"Edit"};
     juce::TextButton bypassButton{"B"};
+    juce::TextButton parallelButton{"||"};
     juce::TextButton removeButton{"X"};
 
     // Per-effect mixing controls
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
 #include <cmath>
 #include <atomic>
 
@@ -166,6 +167,31 @@ public:
         return currentValue * depth;
     }
 
+    // Advance by numSamples and write the value tick() would return at samples
+    // 0, stride, 2*stride... into out (ceil(numSamples / stride) values).
+    // Stages are stepped through analytically, so the curve is only evaluated
+    // once per output point instead of once per sample.
+    void renderBlock(float* out, int numSamples, int stride)
+    {
+        int advanced = 0;
+        int numPoints = 0;
+
+        for (int sample = 0; sample < numSamples; sample += stride)
+        {
+            // tick() advances before computing its value, so sample n sees n + 1 steps
+            advance(sample + 1 - advanced);
+            advanced = sample + 1;
+            out[numPoints++] = currentValue;
+        }
+
+        advance(numSamples - advanced);
+
+        if (currentSampleRate <= 0.0)
+            juce::FloatVectorOperations::clear(out, numPoints);
+        else
+            juce::FloatVectorOperations::multiply(out, depth, numPoints);
+    }
+
     // Parameters (all times in ms)
     void setDelay(float ms) { delayMs = juce::jmax(0.0f, ms); }
     void setAttack(float ms) { attackMs = juce::jmax(0.1f, ms); }
@@ -248,6 +274,90 @@ public:
     }
 
 private:
+    // Per-sample progress increment of a timed stage (matches tick())
+    float getStageIncrement() const
+    {
+        float timeMs = 0.0f;
+        switch (stage)
+        {
+            case Stage::Delay:   timeMs = delayMs; break;
+            case Stage::Attack:  timeMs = attackMs; break;
+            case Stage::Hold:    timeMs = holdMs; break;
+            case Stage::Decay:   timeMs = decayMs; break;
+            case Stage::Release: timeMs = releaseMs; break;
+            case Stage::Idle:
+            case Stage::Sustain: break;
+        }
+        return 1.0f / (static_cast<float>(currentSampleRate) * (timeMs / 1000.0f) + 1.0f);
+    }
+
+    // Envelope value for the current stage at its current progress
+    float getStageValue() const
+    {
+        switch (stage)
+        {
+            case Stage::Idle:
+            case Stage::Delay:
+                return 0.0f;
+            case Stage::Attack:
+                return attackCurve > 0.0f ? std::pow(stageProgress, 1.0f / (1.0f + attackCurve)) : stageProgress;
+            case Stage::Hold:
+                return 1.0f;
+            case Stage::Decay:
+            {
+                float decayRange = 1.0f - sustainLevel;
+                return decayCurve > 0.0f ? 1.0f - decayRange * std::pow(stageProgress, 1.0f + decayCurve)
+                                         : 1.0f - decayRange * stageProgress;
+            }
+            case Stage::Sustain:
+                return sustainLevel;
+            case Stage::Release:
+                return releaseCurve > 0.0f ? releaseStartValue * (1.0f - std::pow(stageProgress, 1.0f + releaseCurve))
+                                           : releaseStartValue * (1.0f - stageProgress);
+        }
+        return 0.0f;
+    }
+
+    // Equivalent to calling tick() numSamples times, without per-sample work
+    void advance(int numSamples)
+    {
+        if (numSamples <= 0 || currentSampleRate <= 0.0)
+            return;
+
+        while (numSamples > 0)
+        {
+            if (stage == Stage::Idle || stage == Stage::Sustain)
+            {
+                currentValue = getStageValue();
+                return;
+            }
+
+            const float increment = getStageIncrement();
+            const int samplesToEnd = juce::jmax(1, static_cast<int>(std::ceil((1.0f - stageProgress) / increment)));
+
+            if (numSamples < samplesToEnd)
+            {
+                stageProgress += static_cast<float>(numSamples) * increment;
+                currentValue = getStageValue();
+                return;
+            }
+
+            // Stage completes - same transitions as tick()
+            numSamples -= samplesToEnd;
+            stageProgress = 0.0f;
+            switch (stage)
+            {
+                case Stage::Delay:   currentValue = 0.0f;         stage = Stage::Attack;  break;
+                case Stage::Attack:  currentValue = 1.0f;         stage = Stage::Hold;    break;
+                case Stage::Hold:    currentValue = 1.0f;         stage = Stage::Decay;   break;
+                case Stage::Decay:   currentValue = sustainLevel; stage = Stage::Sustain; break;
+                case Stage::Release: currentValue = 0.0f;         stage = Stage::Idle;    break;
+                case Stage::Idle:
+                case Stage::Sustain: break;
+            }
+        }
+    }
+
     double currentSampleRate = 44100.0;
 
     // Stage state
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <cmath>
+#include <type_traits>
+
+// Linear gain segment across one block: sample i gets start + (end - start) * i / numSamples
+struct GainRamp
+{
+    float start = 1.0f;
+    float end = 1.0f;
+
+    bool isConstant() const { return start == end; }
+    bool isUnity() const { return start == 1.0f && end == 1.0f; }
+};
+
+// Gain that glides to new targets over a fixed time instead of jumping, so
+// knob moves don't zipper. Audio thread only; next() yields one ramp per block.
+class SmoothedGain
+{
+public:
+    // Message thread - the first target after this is taken without a ramp
+    void prepare(int newRampLengthSamples)
+    {
+        rampLength = juce::jmax(1, newRampLengthSamples);
+        primed = false;
+        remaining = 0;
+    }
+
+    void setTarget(float newTarget)
+    {
+        if (!primed)
+        {
+            current = target = newTarget;
+            primed = true;
+            return;
+        }
+
+        if (newTarget != target)
+        {
+            target = newTarget;
+            step = (target - current) / static_cast<float>(rampLength);
+            remaining = rampLength;
+        }
+    }
+
+    GainRamp next(int numSamples)
+    {
+        GainRamp ramp { current, current };
+        if (remaining > 0)
+        {
+            const int n = juce::jmin(numSamples, remaining);
+            remaining -= n;
+            current = remaining > 0 ? current + step * static_cast<float>(n) : target;
+            ramp.end = current;
+        }
+        return ramp;
+    }
+
+private:
+    float current = 1.0f;
+    float target = 1.0f;
+    float step = 0.0f;
+    int remaining = 0;
+    int rampLength = 1;
+    bool primed = false;
+};
+
+struct ChannelLevels
+{
+    float peak = 0.0f;
+    float rms = 0.0f;
+};
+
+// Fused trim / wet-dry / metering pass. For every sample of every channel:
+//
+//     out = in * gain * wet + dry * (1 - wet)
+//
+// with gain and wet ramping linearly across the block, then captures the
+// peak and RMS of the result. Replaces separate applyGain / addFrom /
+// getMagnitude passes with one. The inner loop runs four independent lanes
+// so the compiler can keep them in SIMD registers without fast-math.
+// Works on float or double audio; the arithmetic runs in the audio's type.
+namespace GainMixKernel
+{
+    constexpr int LANES = 4;
+
+    // Keeps SampleType from being deduced from a nullptr dry argument
+    template <typename T>
+    using NonDeduced = typename std::common_type<T>::type;
+
+    template <bool hasDry, typename SampleType>
+    inline ChannelLevels processChannel(SampleType* data, const SampleType* dryData, int numSamples,
+                                        SampleType gainStart, SampleType gainInc, SampleType wetStart, SampleType wetInc)
+    {
+        SampleType peak[LANES] = {};
+        SampleType sumSquares[LANES] = {};
+
+        auto processSample = [&](int i, int lane)
+        {
+            const SampleType t = static_cast<SampleType>(i);
+            const SampleType g = gainStart + gainInc * t;
+            const SampleType w = wetStart + wetInc * t;
+            SampleType y = data[i] * g * w;
+            if constexpr (hasDry)
+                y += dryData[i] * (SampleType(1) - w);
+            data[i] = y;
+
+            const SampleType a = std::abs(y);
+            peak[lane] = a > peak[lane] ? a : peak[lane];
+            sumSquares[lane] += y * y;
+        };
+
+        int i = 0;
+        for (; i + LANES <= numSamples; i += LANES)
+            for (int lane = 0; lane < LANES; ++lane)
+                processSample(i + lane, lane);
+
+        for (; i < numSamples; ++i)
+            processSample(i, 0);
+
+        ChannelLevels levels;
+        levels.peak = static_cast<float>(juce::jmax(juce::jmax(peak[0], peak[1]), juce::jmax(peak[2], peak[3])));
+        levels.rms = static_cast<float>(std::sqrt((sumSquares[0] + sumSquares[1] + sumSquares[2] + sumSquares[3])
+                                                  / static_cast<SampleType>(numSamples)));
+        return levels;
+    }
+
+    // dry may be nullptr (no dry path). levels may be nullptr, or must hold numChannels entries.
+    template <typename SampleType>
+    inline void process(SampleType* const* channels, const NonDeduced<SampleType>* const* dry, int numChannels,
+                        int numSamples, GainRamp gain, GainRamp wet, ChannelLevels* levels)
+    {
+        if (numSamples <= 0)
+            return;
+
+        const auto gainStart = static_cast<SampleType>(gain.start);
+        const auto wetStart = static_cast<SampleType>(wet.start);
+        const auto gainInc = static_cast<SampleType>(gain.end - gain.start) / static_cast<SampleType>(numSamples);
+        const auto wetInc = static_cast<SampleType>(wet.end - wet.start) / static_cast<SampleType>(numSamples);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto channelLevels = dry != nullptr
+                ? processChannel<true>(channels[ch], dry[ch], numSamples, gainStart, gainInc, wetStart, wetInc)
+                : processChannel<false>(channels[ch], static_cast<const SampleType*>(nullptr), numSamples,
+                                        gainStart, gainInc, wetStart, wetInc);
+
+            if (levels != nullptr)
+                levels[ch] = channelLevels;
+        }
+    }
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <clap/clap.h>
 #include <cmath>
 #include <atomic>
 
@@ -110,11 +112,98 @@ public:
             buffer[i] = tick();
     }
 
+    // Advance by numSamples and write the value tick() would return at samples
+    // 0, stride, 2*stride... into out (ceil(numSamples / stride) values).
+    // Phase is computed directly for each output point, so the cost scales with
+    // the number of points rather than the number of samples.
+    void renderBlock(float* out, int numSamples, int stride)
+    {
+        const int numPoints = (numSamples + stride - 1) / stride;
+        if (numPoints <= 0)
+            return;
+
+        if (currentSampleRate <= 0.0)
+        {
+            juce::FloatVectorOperations::clear(out, numPoints);
+            return;
+        }
+
+        const double increment = frequency / currentSampleRate;
+        const double pointIncrement = increment * stride;
+
+        switch (waveform)
+        {
+            case LFOWaveform::Sine:
+                for (int i = 0; i < numPoints; ++i)
+                    out[i] = fastSine(wrapPhase(phase + i * pointIncrement));
+                break;
+
+            case LFOWaveform::Triangle:
+                // Triangle: 0->1->0->-1->0, as a branch-free fold of the quarter-shifted phase
+                for (int i = 0; i < numPoints; ++i)
+                    out[i] = 1.0f - 4.0f * std::abs(wrapPhase(phase + 0.25 + i * pointIncrement) - 0.5f);
+                break;
+
+            case LFOWaveform::Saw:
+                for (int i = 0; i < numPoints; ++i)
+                    out[i] = wrapPhase(phase + i * pointIncrement) * 2.0f - 1.0f;
+                break;
+
+            case LFOWaveform::Square:
+                for (int i = 0; i < numPoints; ++i)
+                    out[i] = wrapPhase(phase + i * pointIncrement) < 0.5f ? 1.0f : -1.0f;
+                break;
+
+            case LFOWaveform::Random:
+            {
+                // A new value is drawn on every sample whose advance crosses a cycle
+                // boundary; only whether one happened since the last point matters
+                double lastCycle = std::floor(phase);
+                for (int i = 0; i < numPoints; ++i)
+                {
+                    const double cycle = std::floor(phase + (i * stride + 1) * increment);
+                    if (cycle > lastCycle)
+                        randomValue = juce::Random::getSystemRandom().nextFloat() * 2.0f - 1.0f;
+                    lastCycle = cycle;
+                    out[i] = randomValue;
+                }
+
+                if (std::floor(phase + numSamples * increment) > lastCycle)
+                    randomValue = juce::Random::getSystemRandom().nextFloat() * 2.0f - 1.0f;
+                break;
+            }
+        }
+
+        juce::FloatVectorOperations::multiply(out, depth, numPoints);
+
+        phase += numSamples * increment;
+        if (phase >= 1.0)
+            phase -= std::floor(phase);
+    }
+
     float getFrequency() const { return frequency; }
     float getDepth() const { return depth; }
     LFOWaveform getWaveform() const { return waveform; }
 
 private:
+    static float wrapPhase(double p)
+    {
+        return static_cast<float>(p - std::floor(p));
+    }
+
+    // sin(2*pi*t) for t in [0, 1): fold to a quarter cycle, then a 7th-order
+    // odd polynomial (max error ~2e-4, plenty for a control signal)
+    static float fastSine(float t)
+    {
+        float x = t - 0.5f;                           // [-0.5, 0.5), sin(2*pi*t) = -sin(2*pi*x)
+        x = x > 0.25f ? 0.5f - x : x;
+        x = x < -0.25f ? -0.5f - x : x;               // [-0.25, 0.25]
+
+        const float y = x * juce::MathConstants<float>::twoPi;
+        const float y2 = y * y;
+        return -y * (1.0f + y2 * (-1.0f / 6.0f + y2 * (1.0f / 120.0f + y2 * (-1.0f / 5040.0f))));
+    }
+
     double currentSampleRate = 44100.0;
     double phase = 0.0;
     float frequency = 1.0f;    // Hz
@@ -137,12 +226,15 @@ enum class ModSourceType
 // Modulation target - identifies a parameter in a slot
 struct ModulationTarget
 {
-    int slotIndex = -1;             // Which effect slot
+    int slotIndex = -1;             // Which effect slot (kept in step with pluginInstanceId on chain edits)
+    uint64_t pluginInstanceId = 0;  // CLAPPluginInstance::getInstanceId() of the target plugin
     clap_id paramId = 0;            // CLAP parameter ID
     juce::String paramName;         // For display
     double minValue = 0.0;          // Parameter range
     double maxValue = 1.0;
     bool isModulatable = false;
+    void* cookie = nullptr;         // CLAP parameter cookie (fast path for the plugin)
+    uint32_t cookieGeneration = 0;  // Plugin's cookie generation when the cookie was fetched
 
     bool isValid() const { return slotIndex >= 0 && isModulatable; }
 };
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <vector>
+#include "RealtimeScratch.h"
+#include "LFO.h"
+#include "Envelope.h"
+#include "StepSequencer.h"
+
+// Renders every modulation source exactly once per block into a control buffer
+// with one value per MOD_BLOCK_SIZE samples. Slots and routes read from these
+// buffers instead of ticking the sources themselves, so source timing no longer
+// depends on how many CLAP slots are in the chain.
+class ModulationEngine
+{
+public:
+    static constexpr int MOD_BLOCK_SIZE = RealtimeScratch::MOD_BLOCK_SIZE;
+
+    // The source counts fix the row layout, so compiled route tables can refer to
+    // sources by row before the engine has been prepared
+    ModulationEngine(int numLFOsToUse, int numEnvelopesToUse, int numStepSeqsToUse, int numMacrosToUse)
+        : numLFOs(numLFOsToUse), numEnvelopes(numEnvelopesToUse),
+          numStepSeqs(numStepSeqsToUse), numMacros(numMacrosToUse)
+    {}
+
+    // Message thread - sizes the control buffers for the largest block
+    void prepare(int maxBlockSize)
+    {
+        maxControlPoints = maxBlockSize / MOD_BLOCK_SIZE + 1;
+        numControlPoints = 0;
+
+        controlValues.assign(static_cast<size_t>(getNumSources() * maxControlPoints), 0.0f);
+    }
+
+    // Audio thread - advance all sources by numSamples and capture their value
+    // at the start of each MOD_BLOCK_SIZE sub-block
+    void render(LFO* lfos, Envelope* envelopes, StepSequencer* stepSequencers,
+                std::atomic<float>* const* macroParams, int numSamples)
+    {
+        numControlPoints = juce::jmin(maxControlPoints, (numSamples + MOD_BLOCK_SIZE - 1) / MOD_BLOCK_SIZE);
+
+        // Not prepared yet, or the host overran the prepared block size
+        jassert(numSamples <= maxControlPoints * MOD_BLOCK_SIZE);
+        if (numSamples > maxControlPoints * MOD_BLOCK_SIZE)
+        {
+            numControlPoints = 0;
+            return;
+        }
+
+        for (int i = 0; i < numLFOs; ++i)
+            lfos[i].renderBlock(getWritePointer(ModSourceType::LFO, i), numSamples, MOD_BLOCK_SIZE);
+
+        for (int i = 0; i < numEnvelopes; ++i)
+            envelopes[i].renderBlock(getWritePointer(ModSourceType::Envelope, i), numSamples, MOD_BLOCK_SIZE);
+
+        for (int i = 0; i < numStepSeqs; ++i)
+            stepSequencers[i].renderBlock(getWritePointer(ModSourceType::StepSequencer, i), numSamples, MOD_BLOCK_SIZE);
+
+        // Macros are block-rate: map 0..1 to bipolar -1..1
+        for (int i = 0; i < numMacros; ++i)
+        {
+            const float value = macroParams[i] != nullptr ? macroParams[i]->load() * 2.0f - 1.0f : 0.0f;
+            float* dest = getWritePointer(ModSourceType::Macro, i);
+            for (int point = 0; point < numControlPoints; ++point)
+                dest[point] = value;
+        }
+    }
+
+    // Number of control points produced by the last render()
+    int getNumControlPoints() const { return numControlPoints; }
+
+    // Row of a source in the control matrix, or -1 if the index is out of range
+    int getSourceRow(ModSourceType type, int index) const
+    {
+        switch (type)
+        {
+            case ModSourceType::LFO:
+                return (index >= 0 && index < numLFOs) ? index : -1;
+            case ModSourceType::Envelope:
+                return (index >= 0 && index < numEnvelopes) ? numLFOs + index : -1;
+            case ModSourceType::StepSequencer:
+                return (index >= 0 && index < numStepSeqs) ? numLFOs + numEnvelopes + index : -1;
+            case ModSourceType::Macro:
+                return (index >= 0 && index < numMacros) ? numLFOs + numEnvelopes + numStepSeqs + index : -1;
+        }
+        return -1;
+    }
+
+    int getNumSources() const { return numLFOs + numEnvelopes + numStepSeqs + numMacros; }
+
+    // Control buffer for a row from getSourceRow() (getNumControlPoints() values)
+    const float* getRow(int row) const
+    {
+        return controlValues.data() + row * maxControlPoints;
+    }
+
+private:
+    float* getWritePointer(ModSourceType type, int index)
+    {
+        return controlValues.data() + getSourceRow(type, index) * maxControlPoints;
+    }
+
+    const int numLFOs;
+    const int numEnvelopes;
+    const int numStepSeqs;
+    const int numMacros;
+    int maxControlPoints = 0;
+    int numControlPoints = 0;
+
+    // [source][controlPoint], sources laid out LFOs, envelopes, step seqs, macros
+    std::vector<float> controlValues;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ModulationEngine)
+};
@@ -54,6 +54,10 @@ UhbikWrapperAudioProcessorEditor::UhbikWrapperAudioProcessorEditor (UhbikWrapper
     duckerEnableButton.setColour(juce::ToggleButton::tickColourId, juce::Colour(0xff44aa44));
     addChildComponent(duckerEnableButton);  // Hidden until expanded
 
+    duckerRmsButton.addListener(this);
+    duckerRmsButton.setColour(juce::ToggleButton::tickColourId, juce::Colour(0xff44aa44));
+    addChildComponent(duckerRmsButton);
+
     // Threshold slider (-60 to 0 dB)
     duckerThresholdSlider.setSliderStyle(juce::Slider::RotaryHorizontalVerticalDrag);
     duckerThresholdSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 50, 14);
@@ -121,6 +125,19 @@ UhbikWrapperAudioProcessorEditor::UhbikWrapperAudioProcessorEditor (UhbikWrapper
     duckerHoldLabel.setFont(juce::Font(12.0f));
     addChildComponent(duckerHoldLabel);
 
+    // Lookahead slider (0 to 20 ms)
+    duckerLookaheadSlider.setSliderStyle(juce::Slider::RotaryHorizontalVerticalDrag);
+    duckerLookaheadSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 50, 14);
+    duckerLookaheadSlider.setRange(0.0, Ducker::MAX_LOOKAHEAD_MS, 0.1);
+    duckerLookaheadSlider.setValue(audioProcessor.duckerLookaheadMs.load());
+    duckerLookaheadSlider.setTextValueSuffix(" ms");
+    duckerLookaheadSlider.addListener(this);
+    addChildComponent(duckerLookaheadSlider);
+    duckerLookaheadLabel.setJustificationType(juce::Justification::centred);
+    duckerLookaheadLabel.setColour(juce::Label::textColourId, juce::Colours::white);
+    duckerLookaheadLabel.setFont(juce::Font(12.0f));
+    addChildComponent(duckerLookaheadLabel);
+
     // === Modulation Panel Setup ===
     modPanelToggleButton.addListener(this);
     modPanelToggleButton.setColour(juce::TextButton::buttonColourId, juce::Colour(0xff4466aa));
@@ -394,11 +411,13 @@ UhbikWrapperAudioProcessorEditor::~UhbikWrapperAudioProcessorEditor()
     viewMenuButton.removeListener(this);
     duckerToggleButton.removeListener(this);
     duckerEnableButton.removeListener(this);
+    duckerRmsButton.removeListener(this);
     duckerThresholdSlider.removeListener(this);
     duckerAmountSlider.removeListener(this);
     duckerAttackSlider.removeListener(this);
     duckerReleaseSlider.removeListener(this);
     duckerHoldSlider.removeListener(this);
+    duckerLookaheadSlider.removeListener(this);
 
     // Modulation panel cleanup
     modPanelToggleButton.removeListener(this);
@@ -452,7 +471,7 @@ void UhbikWrapperAudioProcessorEditor::timerCallback()
     // Update level meters for each slot
     for (size_t i = 0; i < slotComponents.size() && i < static_cast<size_t>(chainSize); ++i)
     {
-        auto& slot = audioProcessor.effectChain[i];
+        auto& slot = *audioProcessor.effectChain[i];
         slotComponents[i]->setLevels(
             slot.inputLevelL.load(),
             slot.inputLevelR.load(),
@@ -461,6 +480,13 @@ void UhbikWrapperAudioProcessorEditor::timerCallback()
         );
     }
 
+    // Parameter values changed in a CLAP plugin's own GUI
+    if (audioProcessor.getCLAPParamValueGeneration() != shownParamValueGeneration)
+    {
+        shownParamValueGeneration = audioProcessor.getCLAPParamValueGeneration();
+        matrixRoutesList.repaint();
+    }
+
     // Repaint footer for master meters and ducker GR meter
     repaint(0, getHeight() - 30, getWidth(), 30);
 
@@ -574,6 +600,10 @@ void UhbikWrapperAudioProcessorEditor::buttonClicked(juce::Button* button)
     {
         audioProcessor.duckerEnabled.store(duckerEnableButton.getToggleState());
     }
+    else if (button == &duckerRmsButton)
+    {
+        audioProcessor.duckerRmsDetector.store(duckerRmsButton.getToggleState());
+    }
     // Modulation panel buttons
     else if (button == &modPanelToggleButton)
     {
@@ -683,6 +713,8 @@ void UhbikWrapperAudioProcessorEditor::sliderValueChanged(juce::Slider* slider)
         audioProcessor.duckerReleaseMs.store(static_cast<float>(slider->getValue()));
     else if (slider == &duckerHoldSlider)
         audioProcessor.duckerHoldMs.store(static_cast<float>(slider->getValue()));
+    else if (slider == &duckerLookaheadSlider)
+        audioProcessor.duckerLookaheadMs.store(static_cast<float>(slider->getValue()));
 
     // LFO sliders
     for (int i = 0; i < 4; ++i)
@@ -760,6 +792,8 @@ void UhbikWrapperAudioProcessorEditor::updateDuckerUI()
 {
     duckerEnableButton.setVisible(duckerExpanded);
     duckerEnableButton.setToggleState(audioProcessor.duckerEnabled.load(), juce::dontSendNotification);
+    duckerRmsButton.setVisible(duckerExpanded);
+    duckerRmsButton.setToggleState(audioProcessor.duckerRmsDetector.load(), juce::dontSendNotification);
 
     duckerThresholdSlider.setVisible(duckerExpanded);
     duckerThresholdLabel.setVisible(duckerExpanded);
@@ -771,6 +805,8 @@ void UhbikWrapperAudioProcessorEditor::updateDuckerUI()
     duckerReleaseLabel.setVisible(duckerExpanded);
     duckerHoldSlider.setVisible(duckerExpanded);
     duckerHoldLabel.setVisible(duckerExpanded);
+    duckerLookaheadSlider.setVisible(duckerExpanded);
+    duckerLookaheadLabel.setVisible(duckerExpanded);
 
     // Update toggle button text
     duckerToggleButton.setButtonText(duckerExpanded ? "DUCKER v" : "DUCKER >");
@@ -864,7 +900,7 @@ void UhbikWrapperAudioProcessorEditor::populateMatrixSlotBox()
 
     for (int i = 0; i < chainSize; ++i)
     {
-        auto& slot = audioProcessor.effectChain[static_cast<size_t>(i)];
+        auto& slot = *audioProcessor.effectChain[static_cast<size_t>(i)];
         if (slot.isCLAP())  // Only CLAP plugins support modulation
         {
             matrixSlotBox.addItem(slot.description.name, i + 1);
@@ -921,6 +957,11 @@ void UhbikWrapperAudioProcessorEditor::ModRouteListModel::paintListBoxItem(
                         route.target.paramName + " (" +
                         juce::String(static_cast<int>(route.amount * 100)) + "%)";
 
+    // The base value last set in the plugin's own GUI
+    double value = 0.0;
+    if (editor.audioProcessor.getReportedCLAPParameterValue(route.target.slotIndex, route.target.paramId, value))
+        text << " = " << juce::String(value, 2);
+
     g.drawText(text, 5, 0, w - 30, h, juce::Justification::centredLeft);
 
     // Draw X button for removal
@@ -1025,19 +1066,21 @@ void UhbikWrapperAudioProcessorEditor::refreshChainDisplay()
 
     for (int i = 0; i < chainSize; ++i)
     {
-        auto& slot = audioProcessor.effectChain[static_cast<size_t>(i)];
+        auto& slot = *audioProcessor.effectChain[static_cast<size_t>(i)];
         bool canMoveUp = (i > 0);
         bool canMoveDown = (i < chainSize - 1);
         auto slotComp = std::make_unique<EffectSlotComponent>(
             i,
             slot.description.name,
-            slot.bypassed,
+            slot.bypassed.load(),
             canMoveUp,
             canMoveDown,
             slot.inputGainDb.load(),
             slot.outputGainDb.load(),
             slot.mixPercent.load()
         );
+        slotComp->setParallel(slot.parallelWithPrevious, i > 0);
+        slotComp->setLoading(slot.loading);
         slotComp->setListener(this);
         slotComp->setBounds(leftPadding, topPadding + i * (slotHeight + slotSpacing),
                             containerWidth - leftPadding - rightPadding, slotHeight);
@@ -1059,11 +1102,21 @@ void UhbikWrapperAudioProcessorEditor::effectSlotBypassClicked(int slotIndex)
     std::cerr << "[UI] Bypass clicked for slot: " << slotIndex << std::endl << std::flush;
     if (slotIndex >= 0 && slotIndex < audioProcessor.getChainSize())
     {
-        bool currentBypass = audioProcessor.effectChain[static_cast<size_t>(slotIndex)].bypassed;
+        bool currentBypass = audioProcessor.effectChain[static_cast<size_t>(slotIndex)]->bypassed.load();
         audioProcessor.setPluginBypassed(slotIndex, !currentBypass);
     }
 }
 
+void UhbikWrapperAudioProcessorEditor::effectSlotParallelClicked(int slotIndex)
+{
+    std::cerr << "[UI] Parallel clicked for slot: " << slotIndex << std::endl << std::flush;
+    if (slotIndex > 0 && slotIndex < audioProcessor.getChainSize())
+    {
+        bool currentParallel = audioProcessor.effectChain[static_cast<size_t>(slotIndex)]->parallelWithPrevious;
+        audioProcessor.setSlotParallel(slotIndex, !currentParallel);
+    }
+}
+
 void UhbikWrapperAudioProcessorEditor::effectSlotRemoveClicked(int slotIndex)
 {
     std::cerr << "[UI] Remove clicked for slot: " << slotIndex << std::endl << std::flush;
@@ -1113,7 +1166,7 @@ void UhbikWrapperAudioProcessorEditor::openPluginEditor(int slotIndex)
         return;
     }
 
-    auto& slot = audioProcessor.effectChain[static_cast<size_t>(slotIndex)];
+    auto& slot = *audioProcessor.effectChain[static_cast<size_t>(slotIndex)];
     std::cerr << "[UI] Slot: isCLAP=" << slot.isCLAP() << " isVST3=" << slot.isVST3()
               << " hasPlugin=" << slot.hasPlugin() << std::endl << std::flush;
 
@@ -1316,6 +1369,14 @@ void UhbikWrapperAudioProcessorEditor::paint (juce::Graphics& g)
         g.fillRect(browserWidth + 45, meterY, inLevelWidth, meterHeight);
     }
 
+    // Input RMS tick
+    int inRmsX = static_cast<int>(juce::jmin(1.0f, audioProcessor.masterInputRms.load()) * meterWidth);
+    if (inRmsX > 0)
+    {
+        g.setColour(juce::Colours::white.withAlpha(0.7f));
+        g.fillRect(browserWidth + 45 + inRmsX - 1, meterY, 2, meterHeight);
+    }
+
     // Output meter label and bar
     g.setColour(juce::Colours::grey);
     g.drawText("OUT", browserWidth + 115, meterY - 2, 25, 12, juce::Justification::centredRight);
@@ -1340,10 +1401,29 @@ void UhbikWrapperAudioProcessorEditor::paint (juce::Graphics& g)
         g.fillRect(browserWidth + 145, meterY, outLevelWidth, meterHeight);
     }
 
+    // Output RMS tick
+    int outRmsX = static_cast<int>(juce::jmin(1.0f, audioProcessor.masterOutputRms.load()) * meterWidth);
+    if (outRmsX > 0)
+    {
+        g.setColour(juce::Colours::white.withAlpha(0.7f));
+        g.fillRect(browserWidth + 145 + outRmsX - 1, meterY, 2, meterHeight);
+    }
+
+    // DSP load on the right: actual, and the estimate without the worker pool
+    int cpuWidth = 170;
+    int cpuPercent = juce::roundToInt(audioProcessor.cpuLoad.load() * 100.0f);
+    int serialPercent = juce::roundToInt(audioProcessor.serialCpuLoad.load() * 100.0f);
+    juce::String cpuText = "CPU " + juce::String(cpuPercent) + "%";
+    if (audioProcessor.getNumWorkerThreads() > 0)
+        cpuText << " (serial " << serialPercent << "%, " << audioProcessor.getNumWorkerThreads() << " thr)";
+    g.setColour(cpuPercent > 90 ? juce::Colour(0xffff3333) : juce::Colours::grey);
+    g.setFont(10.0f);
+    g.drawText(cpuText, getWidth() - cpuWidth - 10, getHeight() - 30, cpuWidth, 30, juce::Justification::centredRight);
+
     // Status message (shifted right to make room for meters)
     g.setColour(juce::Colours::lightgrey);
     g.setFont(12.0f);
-    g.drawFittedText(statusMessage, browserWidth + 220, getHeight() - 30, getWidth() - browserWidth - 240, 30, juce::Justification::centred, 1);
+    g.drawFittedText(statusMessage, browserWidth + 220, getHeight() - 30, getWidth() - browserWidth - 240 - cpuWidth, 30, juce::Justification::centred, 1);
 
     // Empty state message
     if (audioProcessor.getChainSize() == 0)
@@ -1404,7 +1484,8 @@ void UhbikWrapperAudioProcessorEditor::resized()
         int startX = duckerBounds.getX() + 110;
 
         // Enable button
-        duckerEnableButton.setBounds(startX - 60, controlY + 18, 50, 25);
+        duckerEnableButton.setBounds(startX - 60, controlY + 10, 50, 25);
+        duckerRmsButton.setBounds(startX - 60, controlY + 38, 50, 25);
 
         // Threshold - label above knob
         duckerThresholdLabel.setBounds(startX, controlY, knobSize, labelHeight);
@@ -1425,6 +1506,10 @@ void UhbikWrapperAudioProcessorEditor::resized()
         // Hold
         duckerHoldLabel.setBounds(startX + spacing * 4, controlY, knobSize, labelHeight);
         duckerHoldSlider.setBounds(startX + spacing * 4, controlY + labelHeight, knobSize, knobSize);
+
+        // Lookahead (label is wider than the knob)
+        duckerLookaheadLabel.setBounds(startX + spacing * 5 - 10, controlY, knobSize + 20, labelHeight);
+        duckerLookaheadSlider.setBounds(startX + spacing * 5, controlY + labelHeight, knobSize, knobSize);
     }
 
     // Modulation panel (collapsible, above ducker)
@@ -1664,6 +1749,16 @@ void UhbikWrapperAudioProcessorEditor::showViewMenu()
     menu.addItem(3, "200%", true, uiScale == 2.0f);
     menu.addItem(4, "300%", true, uiScale == 3.0f);
 
+    menu.addSeparator();
+    menu.addSectionHeader("Worker Threads");
+    int numWorkers = audioProcessor.getNumWorkerThreads();
+    menu.addItem(30, "Off", true, numWorkers == 0);
+    menu.addItem(31, "1", true, numWorkers == 1);
+    menu.addItem(32, "2", true, numWorkers == 2);
+    menu.addItem(34, "4", true, numWorkers == 4);
+    menu.addItem(38, "8", true, numWorkers == 8);
+    menu.addItem(39, "Pipelined Chain (adds latency)", numWorkers > 0, audioProcessor.isPipelinedChain());
+
     menu.addSeparator();
     menu.addSectionHeader("Debug");
     menu.addItem(10, "Debug Logging", true, audioProcessor.debugLogging.load());
@@ -1681,6 +1776,10 @@ void UhbikWrapperAudioProcessorEditor::showViewMenu()
                 case 20: formatFilter.setSelectedId(1); populatePluginSelector(); break;
                 case 21: formatFilter.setSelectedId(2); populatePluginSelector(); break;
                 case 22: formatFilter.setSelectedId(3); populatePluginSelector(); break;
+                case 30: case 31: case 32: case 34: case 38:
+                    audioProcessor.setNumWorkerThreads(result - 30);
+                    break;
+                case 39: audioProcessor.setPipelinedChain(!audioProcessor.isPipelinedChain()); break;
                 default: break;
             }
         });
@@ -1735,7 +1834,7 @@ void UhbikWrapperAudioProcessorEditor::savePresetRequested(const juce::File& fol
     {
         auto* plugin = audioProcessor.getPluginAt(i);
         if (plugin != nullptr)
-            pluginNames.add(audioProcessor.effectChain[static_cast<size_t>(i)].description.name);
+            pluginNames.add(audioProcessor.effectChain[static_cast<size_t>(i)]->description.name);
     }
     preset.setAttribute("plugins", pluginNames.joinIntoString(", "));
     preset.setAttribute("pluginCount", audioProcessor.getChainSize());
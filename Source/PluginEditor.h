@@ -25,6 +25,7 @@ public:
 
     void effectSlotEditClicked(int slotIndex) override;
     void effectSlotBypassClicked(int slotIndex) override;
+    void effectSlotParallelClicked(int slotIndex) override;
     void effectSlotRemoveClicked(int slotIndex) override;
     void effectSlotMoveUpClicked(int slotIndex) override;
     void effectSlotMoveDownClicked(int slotIndex) override;
@@ -90,16 +91,19 @@ private:
     bool duckerExpanded = false;
     juce::TextButton duckerToggleButton{"DUCKER"};
     juce::ToggleButton duckerEnableButton{"ON"};
+    juce::ToggleButton duckerRmsButton{"RMS"};
     juce::Slider duckerThresholdSlider;
     juce::Slider duckerAmountSlider;
     juce::Slider duckerAttackSlider;
     juce::Slider duckerReleaseSlider;
     juce::Slider duckerHoldSlider;
+    juce::Slider duckerLookaheadSlider;
     juce::Label duckerThresholdLabel{"", "Thresh"};
     juce::Label duckerAmountLabel{"", "Amount"};
     juce::Label duckerAttackLabel{"", "Attack"};
     juce::Label duckerReleaseLabel{"", "Release"};
     juce::Label duckerHoldLabel{"", "Hold"};
+    juce::Label duckerLookaheadLabel{"", "Lookahead"};
 
     // Modulation panel (collapsible, tabbed)
     bool modPanelExpanded = false;
@@ -157,6 +161,7 @@ private:
     juce::TextButton matrixClearButton{"Clear All"};
     juce::Label matrixRoutesLabel{"", "Active Routes:"};
     juce::ListBox matrixRoutesList;
+    uint32_t shownParamValueGeneration = 0;  // Redraw the routes when CLAP plugins report new values
 
     // Route list model
     class ModRouteListModel : public juce::ListBoxModel {
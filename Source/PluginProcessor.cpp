@@ -1,9 +1,14 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "ChainStateFormat.h"
 #include <iostream>
 #include <thread>
 #include <chrono>
 
+#ifndef UHBIK_CHECK_RT_ALLOCATIONS
+    #define UHBIK_CHECK_RT_ALLOCATIONS 0
+#endif
+
 juce::AudioProcessorValueTreeState::ParameterLayout UhbikWrapperAudioProcessor::createParameterLayout()
 {
     std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
@@ -69,13 +74,436 @@ UhbikWrapperAudioProcessor::UhbikWrapperAudioProcessor()
         juce::String macroId = "macro" + juce::String(i + 1);
         macroParams[i] = apvts.getRawParameterValue(macroId);
     }
+    inputGainParam = apvts.getRawParameterValue("inputGain");
+    outputGainParam = apvts.getRawParameterValue("outputGain");
+    mixParam = apvts.getRawParameterValue("mix");
+
+    // The audio thread always has a (possibly empty) chain to read
+    publishChain();
+    startTimer(250);
+
+    setNumWorkerThreads(DEFAULT_WORKER_THREADS);
 }
 
 UhbikWrapperAudioProcessor::~UhbikWrapperAudioProcessor()
 {
+    stopTimer();
+    delete publishedChain.exchange(nullptr);
+    retiredChains.clear();
     effectChain.clear();
 }
 
+// --- Chain publishing ---
+
+void UhbikWrapperAudioProcessor::publishChain()
+{
+    auto snapshot = std::make_unique<ChainSnapshot>();
+    snapshot->slots = effectChain;
+    snapshot->groups = compileGroups(effectChain);
+    compilePipeline(*snapshot);
+    compileRouteTables(*snapshot);
+    updateLatency(*snapshot, true);
+
+    auto* previous = publishedChain.exchange(snapshot.release());
+
+    {
+        const juce::ScopedLock sl(retiredChainsLock);
+        if (previous != nullptr)
+            retiredChains.emplace_back(previous);
+    }
+
+    reclaimRetiredChains();
+}
+
+std::vector<UhbikWrapperAudioProcessor::SlotGroup> UhbikWrapperAudioProcessor::compileGroups(
+    const std::vector<std::shared_ptr<EffectSlot>>& slots)
+{
+    std::vector<SlotGroup> groups;
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        // The first slot has nothing to run alongside
+        if (slots[i]->parallelWithPrevious && !groups.empty())
+            ++groups.back().count;
+        else
+            groups.push_back({ i, 1 });
+    }
+    return groups;
+}
+
+void UhbikWrapperAudioProcessor::compilePipeline(ChainSnapshot& snapshot) const
+{
+    snapshot.stages.clear();
+
+    // One stage per thread (the audio thread runs one too), never more than there are groups
+    const size_t numGroups = snapshot.groups.size();
+    const size_t numStages = juce::jmin(numGroups,
+                                        static_cast<size_t>(workerPool.getNumWorkers() + 1),
+                                        static_cast<size_t>(RealtimeScratch::MAX_PIPELINE_STAGES));
+    if (!pipelinedChain || numStages < 2)
+        return;
+
+    // Balance by slot count - stages close once they hold their share of the slots
+    const size_t numSlots = snapshot.slots.size();
+    size_t slotsSoFar = 0;
+    size_t group = 0;
+    for (size_t stage = 0; stage < numStages; ++stage)
+    {
+        PipelineStage pipelineStage;
+        pipelineStage.firstGroup = group;
+
+        const size_t slotTarget = (numSlots * (stage + 1)) / numStages;
+        const size_t groupsLeftForLaterStages = numStages - stage - 1;
+        while (group < numGroups - groupsLeftForLaterStages
+               && (pipelineStage.numGroups == 0 || slotsSoFar < slotTarget || stage == numStages - 1))
+        {
+            slotsSoFar += snapshot.groups[group].count;
+            ++pipelineStage.numGroups;
+            ++group;
+        }
+
+        snapshot.stages.push_back(pipelineStage);
+    }
+}
+
+void UhbikWrapperAudioProcessor::compileRouteTables(ChainSnapshot& snapshot)
+{
+    const size_t numSlots = snapshot.slots.size();
+    snapshot.routeTables.resize(numSlots);
+
+    // Capture each plugin's cookie generation before reading any cookies - if it
+    // moves on afterwards the audio thread sees the mismatch and drops them
+    std::vector<std::vector<CLAPParameterInfo>> freshParams(numSlots);
+    for (size_t i = 0; i < numSlots; ++i)
+    {
+        if (auto* clap = snapshot.slots[i]->clapPlugin.get())
+        {
+            snapshot.routeTables[i].cookieGeneration = clap->getCookieGeneration();
+            snapshot.routeTables[i].pluginInstanceId = clap->getInstanceId();
+        }
+    }
+
+    for (auto& route : modulationRoutes)
+    {
+        const int slotIndex = route.target.slotIndex;
+        const int sourceRow = modulationEngine.getSourceRow(route.sourceType, route.sourceIndex);
+
+        if (!route.enabled || sourceRow < 0 || slotIndex < 0 || slotIndex >= static_cast<int>(numSlots))
+            continue;
+
+        auto& table = snapshot.routeTables[static_cast<size_t>(slotIndex)];
+
+        // Only ever send a route to the plugin it was made for. Chain edits
+        // retarget routes first, so a mismatch here means a path that didn't.
+        auto* clap = snapshot.slots[static_cast<size_t>(slotIndex)]->clapPlugin.get();
+        if (clap == nullptr || route.target.pluginInstanceId != table.pluginInstanceId)
+        {
+            jassertfalse;
+            continue;
+        }
+
+        // Re-fetch the cookie if the plugin has invalidated them since it was stored
+        if (route.target.cookieGeneration != table.cookieGeneration)
+        {
+            auto& params = freshParams[static_cast<size_t>(slotIndex)];
+            if (params.empty())
+                params = clap->getAllParameters();
+
+            route.target.cookie = nullptr;
+            for (const auto& param : params)
+            {
+                if (param.id == route.target.paramId)
+                {
+                    route.target.cookie = param.cookie;
+                    break;
+                }
+            }
+            route.target.cookieGeneration = table.cookieGeneration;
+        }
+
+        table.sourceRows.push_back(sourceRow);
+        table.scaledAmounts.push_back(route.amount * (route.target.maxValue - route.target.minValue));
+        table.paramIds.push_back(route.target.paramId);
+        table.cookies.push_back(route.target.cookie);
+    }
+}
+
+void UhbikWrapperAudioProcessor::retargetModulationRoutes()
+{
+    modulationRoutes.erase(std::remove_if(modulationRoutes.begin(), modulationRoutes.end(), [this](ModulationRoute& route)
+    {
+        for (size_t i = 0; i < effectChain.size(); ++i)
+        {
+            auto* clap = effectChain[i]->clapPlugin.get();
+            if (clap != nullptr && clap->getInstanceId() == route.target.pluginInstanceId)
+            {
+                route.target.slotIndex = static_cast<int>(i);
+                return false;
+            }
+        }
+
+        if (debugLogging.load())
+            std::cerr << "[RACK] Dropping modulation route to removed plugin: " << route.target.paramName << std::endl;
+        return true;
+    }), modulationRoutes.end());
+}
+
+bool UhbikWrapperAudioProcessor::routeCookiesAreStale() const
+{
+    const auto* chain = publishedChain.load();
+    if (chain == nullptr)
+        return false;
+
+    for (size_t i = 0; i < chain->slots.size() && i < chain->routeTables.size(); ++i)
+    {
+        const auto& table = chain->routeTables[i];
+        auto* clap = chain->slots[i]->clapPlugin.get();
+        if (clap != nullptr && table.size() > 0 && clap->getCookieGeneration() != table.cookieGeneration)
+            return true;
+    }
+    return false;
+}
+
+void UhbikWrapperAudioProcessor::reclaimRetiredChains()
+{
+    const juce::ScopedLock sl(retiredChainsLock);
+
+    // Anything the audio thread isn't holding can go. Dropping the snapshot
+    // releases its slot references, so removed plugins are destroyed here.
+    auto* inUse = audioActiveChain.load();
+    retiredChains.erase(std::remove_if(retiredChains.begin(), retiredChains.end(),
+                                       [inUse](const std::unique_ptr<ChainSnapshot>& retired)
+                                       { return retired.get() != inUse; }),
+                        retiredChains.end());
+}
+
+UhbikWrapperAudioProcessor::ChainSnapshot* UhbikWrapperAudioProcessor::acquireChain()
+{
+    // Announce the snapshot we're about to use, then check it is still the
+    // published one - if not, the message thread may already be retiring it
+    auto* chain = publishedChain.load();
+    for (;;)
+    {
+        audioActiveChain.store(chain);
+        auto* current = publishedChain.load();
+        if (current == chain)
+            return chain;
+        chain = current;
+    }
+}
+
+void UhbikWrapperAudioProcessor::releaseChain()
+{
+    audioActiveChain.store(nullptr);
+}
+
+void UhbikWrapperAudioProcessor::timerCallback()
+{
+    // A CLAP plugin rescanned its parameters - recompile the routes with fresh cookies
+    if (routeCookiesAreStale())
+        publishChain();
+
+    handleCLAPRestartRequests();
+
+    // Plugins can change their latency at any time (e.g. lookahead settings)
+    if (auto* chain = publishedChain.load())
+    {
+        updateLatency(*chain, false);
+        drainCLAPParamEvents(*chain);
+
+        // The input event lanes are sized so nothing should be dropped; say so if
+        // it is. Still consumed with logging off, so turning it on shows only new drops.
+        for (const auto& slot : chain->slots)
+        {
+            if (slot->clapPlugin == nullptr)
+                continue;
+
+            const auto dropped = slot->clapPlugin->consumeDroppedEvents();
+            if (dropped > 0 && debugLogging.load())
+                std::cerr << "[RACK] " << slot->description.name << ": " << dropped
+                          << " CLAP input events dropped (event lane full)" << std::endl;
+        }
+    }
+
+   #if UHBIK_CHECK_RT_ALLOCATIONS
+    // Report audio-thread allocations made since the last tick
+    const auto allocations = RealtimeAllocationCheck::getAllocationCount();
+    if (allocations != reportedAllocationCount)
+    {
+        std::cerr << "[RACK] Audio-thread allocations: " << allocations - reportedAllocationCount
+                  << " new, " << allocations << " total" << std::endl;
+        reportedAllocationCount = allocations;
+    }
+   #endif
+
+    reclaimRetiredChains();
+}
+
+void UhbikWrapperAudioProcessor::handleCLAPRestartRequests()
+{
+    std::vector<std::shared_ptr<EffectSlot>> restarting;
+    for (const auto& slot : effectChain)
+        if (slot->clapPlugin != nullptr && slot->clapPlugin->consumeRestartRequest()
+            && slot->ready.load() && slot->clapPlugin->isActive())
+            restarting.push_back(slot);
+
+    if (restarting.empty())
+        return;
+
+    // Take the plugins out of the audio path first. Only a block that started
+    // on the current snapshot can still see them ready, so publish a fresh one
+    // and wait for the audio thread to let go of the old (at most one block).
+    for (const auto& slot : restarting)
+        slot->ready.store(false);
+
+    const auto* previous = publishedChain.load();
+    publishChain();
+    while (audioActiveChain.load() == previous)
+        juce::Thread::sleep(1);
+
+    const double sr = getSampleRate() > 0 ? getSampleRate() : 44100.0;
+    const int bs = getBlockSize() > 0 ? getBlockSize() : 512;
+
+    for (const auto& slot : restarting)
+    {
+        slot->clapPlugin->deactivate();
+        if (!activateCLAP(*slot->clapPlugin, sr, bs))
+        {
+            // Stays out of the audio path, so the slot passes audio through
+            std::cerr << "[RACK] " << slot->description.name
+                      << ": CLAP plugin failed to reactivate after requesting a restart" << std::endl;
+            continue;
+        }
+
+        negotiatePlugin(*slot);
+        scratch.prepareSlot(slot->scratch, slot->processesDouble, padChannelsFor(*slot));
+        slot->ready.store(true);
+
+        if (debugLogging.load())
+            std::cerr << "[RACK] " << slot->description.name << ": CLAP plugin restarted" << std::endl;
+    }
+
+    // A restart is how a CLAP plugin applies a new latency while active
+    updateLatency(*publishedChain.load(), true);
+}
+
+void UhbikWrapperAudioProcessor::updateLatency(const ChainSnapshot& chain, bool requeryCLAP)
+{
+    for (const auto& slot : chain.slots)
+    {
+        int latency = slot->latencySamples.load();
+        if (slot->vst3Plugin != nullptr)
+        {
+            latency = slot->vst3Plugin->getLatencySamples();
+
+            slot->tailSamples.store(SilenceTracker::vst3TailSamples(slot->vst3Plugin->getTailLengthSeconds(),
+                                                                    currentSampleRate));
+        }
+        else if (slot->clapPlugin != nullptr && (slot->clapPlugin->consumeLatencyChanged() || requeryCLAP))
+            latency = static_cast<int>(slot->clapPlugin->getLatencySamples());
+
+        // Keep within what the slot's compensation delay can hold
+        latency = juce::jlimit(0, slot->scratch.dryDelay.getMaxDelay(), latency);
+        slot->latencySamples.store(latency);
+    }
+
+    const int totalLatency = getChainLatency(chain) + getDuckerLatency();
+    if (totalLatency != getLatencySamples())
+    {
+        if (debugLogging.load())
+            std::cerr << "[RACK] Chain latency changed: " << getLatencySamples() << " -> " << totalLatency << " samples" << std::endl;
+        setLatencySamples(totalLatency);
+    }
+}
+
+void UhbikWrapperAudioProcessor::drainCLAPParamEvents(const ChainSnapshot& chain)
+{
+    // One change notification per completed gesture lets the DAW group the
+    // values in it into a single undo point
+    const auto notifyHost = [this] { updateHostDisplay(ChangeDetails().withNonParameterStateChanged(true)); };
+
+    bool valuesChanged = false;
+    bool looseValuesChanged = false;  // Outside any gesture (e.g. a preset load in the plugin)
+    for (const auto& slot : chain.slots)
+    {
+        auto* clap = slot->clapPlugin.get();
+        if (clap == nullptr)
+            continue;
+
+        clap->drainParamEvents([&](const CLAPParamEvent& event)
+        {
+            if (event.type == CLAPParamEvent::Value)
+            {
+                valuesChanged = true;
+                if (!clap->isParameterGestureActive(event.paramId))
+                    looseValuesChanged = true;
+            }
+            else if (event.type == CLAPParamEvent::GestureEnd)
+            {
+                notifyHost();
+            }
+
+            if (debugLogging.load())
+                std::cerr << "[RACK] " << slot->clapPlugin->getName() << " param " << event.paramId
+                          << (event.type == CLAPParamEvent::Value ? " = " + juce::String(event.value)
+                              : event.type == CLAPParamEvent::GestureBegin ? juce::String(" gesture begin")
+                                                                           : juce::String(" gesture end"))
+                          << std::endl;
+        });
+    }
+
+    // The plugin states saved with the wrapper have changed - lets the DAW mark
+    // the project dirty and take an undo point
+    if (looseValuesChanged)
+        notifyHost();
+
+    if (valuesChanged)
+        ++clapParamValueGeneration;
+}
+
+int UhbikWrapperAudioProcessor::getChainLatency(const ChainSnapshot& chain) const
+{
+    // Parallel branches are padded to their slowest child
+    int totalLatency = 0;
+    for (const auto& group : chain.groups)
+    {
+        int groupLatency = 0;
+        for (size_t i = group.first; i < group.first + group.count; ++i)
+            groupLatency = juce::jmax(groupLatency, chain.slots[i]->latencySamples.load());
+        totalLatency += groupLatency;
+    }
+
+    // Each pipeline stage after the first runs one block behind
+    if (chain.stages.size() > 1)
+        totalLatency += static_cast<int>(chain.stages.size() - 1) * scratch.getMaxBlockSize();
+
+    return totalLatency;
+}
+
+int UhbikWrapperAudioProcessor::getDuckerLatency() const
+{
+    // The ducker runs after the master mix, so its lookahead delays everything
+    return duckerEnabled.load() ? ducker.lookaheadMsToSamples(duckerLookaheadMs.load()) : 0;
+}
+
+float UhbikWrapperAudioProcessor::updateLevelMeters(std::atomic<float>& left, std::atomic<float>& right,
+                                                    const ChannelLevels* levels, int numChannels)
+{
+    float leftPeak = 0.0f, rightPeak = 0.0f, rmsSum = 0.0f;
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto& peak = (ch % 2 == 0) ? leftPeak : rightPeak;
+        peak = juce::jmax(peak, levels[ch].peak);
+        rmsSum += levels[ch].rms;
+    }
+
+    if (numChannels == 1)
+        rightPeak = leftPeak;
+
+    updatePeakMeter(left, leftPeak);
+    updatePeakMeter(right, rightPeak);
+    return rmsSum / static_cast<float>(juce::jmax(1, numChannels));
+}
+
 void UhbikWrapperAudioProcessor::scanForPlugins()
 {
     availablePlugins.clear();
@@ -97,30 +525,66 @@ void UhbikWrapperAudioProcessor::scanForPlugins()
         .getChildFile(".vst3"));
 #endif
 
-    for (int i = 0; i < searchPath.getNumPaths(); ++i)
+    // Bundles whose path, mtime and size match the scan cache aren't loaded at all
+    knownPluginList.clear();
+    scanCache->reload();
+
+    juce::StringArray seenBundles;
+    int numRescanned = 0;
+
+    for (auto* format : pluginFormatManager.getFormats())
     {
-        auto vst3Dir = searchPath[i];
-        if (!vst3Dir.exists())
-            continue;
+        juce::StringArray newBundles;
+        std::vector<PluginScanCache::Stamp> newStamps;
 
-        DBG("Scanning VST3 in: " + vst3Dir.getFullPathName());
+        for (const auto& path : format->searchPathsForPlugins(searchPath, true, false))
+        {
+            seenBundles.add(path);
+            const auto stamp = PluginScanCache::stampFor(juce::File(path));
+
+            juce::OwnedArray<juce::PluginDescription> found;
+            if (!scanCache->findVST3(path, stamp, found))
+            {
+                newBundles.add(path);
+                newStamps.push_back(stamp);
+                continue;
+            }
+
+            for (const auto* desc : found)
+                knownPluginList.addType(*desc);
+        }
 
-        for (auto* format : pluginFormatManager.getFormats())
+        // Load new or changed bundles - in worker processes when we have them, so
+        // a crashing plugin can't take the host down
+        std::map<juce::String, std::unique_ptr<juce::XmlElement>> workerResults;
+        if (!newBundles.isEmpty() && scanWorkers.isAvailable())
+            workerResults = scanWorkers.scan(PluginScanCache::Format::VST3, newBundles);
+
+        for (int i = 0; i < newBundles.size(); ++i)
         {
-            juce::PluginDirectoryScanner scanner(
-                knownPluginList, *format,
-                juce::FileSearchPath(vst3Dir.getFullPathName()),
-                true, juce::File(), false
-            );
-
-            juce::String pluginName;
-            while (scanner.scanNextFile(true, pluginName))
+            const auto& path = newBundles[i];
+            DBG("Scanning VST3: " + path);
+
+            juce::OwnedArray<juce::PluginDescription> found;
+            if (auto result = workerResults.find(path); result != workerResults.end())
+                ScanWorkerPool::readVST3Results(*result->second, found);
+            else
+                format->findAllTypesForFile(found, path);
+
+            scanCache->storeVST3(path, newStamps[static_cast<size_t>(i)], found);
+            ++numRescanned;
+
+            for (const auto* desc : found)
             {
-                DBG("Found VST3: " + pluginName);
+                DBG("Found VST3: " + desc->name);
+                knownPluginList.addType(*desc);
             }
         }
     }
 
+    scanCache->retainOnly(PluginScanCache::Format::VST3, seenBundles);
+    scanCache->save();
+
     // Add VST3 plugins to unified list
     for (const auto& vst3Desc : knownPluginList.getTypes())
     {
@@ -135,172 +599,383 @@ void UhbikWrapperAudioProcessor::scanForPlugins()
         availablePlugins.push_back(unified);
     }
 
-    std::cerr << "[RACK] VST3 plugins found: " << knownPluginList.getNumTypes() << std::endl << std::flush;
+    std::cerr << "[RACK] VST3 plugins found: " << knownPluginList.getNumTypes()
+              << " (" << numRescanned << " of " << seenBundles.size() << " bundles rescanned)" << std::endl << std::flush;
 
     // === Scan CLAP plugins ===
-    // Delay CLAP scan slightly to avoid conflicts with library loading during project restore
-    std::cerr << "[RACK] Deferring CLAP scan..." << std::endl;
-    std::cerr.flush();
-    juce::Timer::callAfterDelay(500, [this]() {
-        std::cerr << "[RACK] Starting deferred CLAP scan..." << std::endl;
-        std::cerr.flush();
-        clapScanner.clear();
-        clapScanner.scanDefaultLocations();
-        std::cerr << "[RACK] CLAP scan complete. Found: " << clapScanner.getPlugins().size() << std::endl;
+    // Cached CLAP results are available right away. Anything new or changed has
+    // to be loaded, which is deferred slightly to avoid conflicts with library
+    // loading during project restore.
+    clapScanner.setCache(&scanCache.get());
+    clapScanner.clear();
+    const bool clapScanComplete = clapScanner.scanDefaultLocations(true);
+    addScannedCLAPPlugins();
+
+    if (!clapScanComplete)
+    {
+        std::cerr << "[RACK] Deferring CLAP scan of new plugins..." << std::endl;
         std::cerr.flush();
+        juce::Timer::callAfterDelay(500, [this]() {
+            std::cerr << "[RACK] Starting deferred CLAP scan..." << std::endl;
+            std::cerr.flush();
+
+            // Another instance may have scanned them in the meantime
+            scanCache->reload();
+            clapScanner.clear();
+            if (!clapScanner.scanDefaultLocations(true))
+            {
+                if (scanWorkers.isAvailable())
+                {
+                    // Load the rest in worker processes, then serve everything from the cache
+                    const auto newFiles = clapScanner.getUncachedFiles();
+                    auto results = scanWorkers.scan(PluginScanCache::Format::CLAP, newFiles);
+                    for (const auto& path : newFiles)
+                    {
+                        std::vector<CLAPPluginDescription> found;
+                        ScanWorkerPool::readCLAPResults(*results[path], found);
+                        scanCache->storeCLAP(path, PluginScanCache::stampFor(juce::File(path)), found);
+                    }
+                    scanCache->save();
 
-        // Add CLAP plugins to unified list
-        for (const auto& clapDesc : clapScanner.getPlugins())
-        {
-            if (clapDesc.isInstrument)
-                continue;
-            UnifiedPluginDescription unified;
-            unified.format = UnifiedPluginDescription::Format::CLAP;
-            unified.name = clapDesc.name + " (CLAP)";
-            unified.pluginId = clapDesc.pluginId;
-            unified.pluginPath = clapDesc.pluginPath;
-            unified.vendor = clapDesc.vendor;
-            unified.isInstrument = clapDesc.isInstrument;
-            unified.clapDesc = clapDesc;
-            availablePlugins.push_back(unified);
-        }
-        std::cerr << "[RACK] CLAP effects added. Total plugins: " << availablePlugins.size() << std::endl;
-        std::cerr.flush();
+                    clapScanner.clear();
+                    clapScanner.scanDefaultLocations(true);
+                }
+                else
+                {
+                    clapScanner.clear();
+                    clapScanner.scanDefaultLocations();
+                }
+            }
+            addScannedCLAPPlugins();
 
-        // Notify any listeners that the plugin list has changed
-        sendChangeMessage();
-    });
+            std::cerr << "[RACK] CLAP scan complete. Total plugins: " << availablePlugins.size() << std::endl;
+            std::cerr.flush();
 
-    // VST3 plugins are available immediately, CLAP plugins will be added after delay
-    std::cerr << "[RACK] VST3 plugins available immediately: " << availablePlugins.size() << std::endl;
+            // Notify any listeners that the plugin list has changed
+            sendChangeMessage();
+        });
+    }
+
+    std::cerr << "[RACK] Plugins available immediately: " << availablePlugins.size() << std::endl;
     std::cerr.flush();
 }
 
-void UhbikWrapperAudioProcessor::addPlugin(const juce::PluginDescription& desc)
+void UhbikWrapperAudioProcessor::addScannedCLAPPlugins()
 {
-    if (debugLogging.load())
-        std::cerr << "[RACK] Adding VST3 plugin: " << desc.name << std::endl << std::flush;
+    // Replace any CLAP entries from an earlier pass
+    availablePlugins.erase(std::remove_if(availablePlugins.begin(), availablePlugins.end(),
+                                          [](const UnifiedPluginDescription& desc)
+                                          { return desc.format == UnifiedPluginDescription::Format::CLAP; }),
+                           availablePlugins.end());
 
-    juce::String errorMsg;
-    auto plugin = pluginFormatManager.createPluginInstance(
-        desc,
-        getSampleRate() > 0 ? getSampleRate() : 44100.0,
-        getBlockSize() > 0 ? getBlockSize() : 512,
-        errorMsg
-    );
+    for (const auto& clapDesc : clapScanner.getPlugins())
+    {
+        if (clapDesc.isInstrument)
+            continue;
+        UnifiedPluginDescription unified;
+        unified.format = UnifiedPluginDescription::Format::CLAP;
+        unified.name = clapDesc.name + " (CLAP)";
+        unified.pluginId = clapDesc.pluginId;
+        unified.pluginPath = clapDesc.pluginPath;
+        unified.vendor = clapDesc.vendor;
+        unified.isInstrument = clapDesc.isInstrument;
+        unified.clapDesc = clapDesc;
+        availablePlugins.push_back(unified);
+    }
+}
 
-    if (plugin != nullptr)
+namespace
+{
+    UnifiedPluginDescription unifiedDescriptionFor(const juce::PluginDescription& desc)
     {
-        if (debugLogging.load())
-            std::cerr << "[RACK] Plugin created, configuring buses..." << std::endl << std::flush;
+        UnifiedPluginDescription unified;
+        unified.format = UnifiedPluginDescription::Format::VST3;
+        unified.name = desc.name;
+        unified.pluginId = desc.uniqueId != 0 ? juce::String(desc.uniqueId) : desc.fileOrIdentifier;
+        unified.pluginPath = desc.fileOrIdentifier;
+        unified.vendor = desc.manufacturerName;
+        unified.isInstrument = desc.isInstrument;
+        unified.vst3Desc = desc;
+        return unified;
+    }
 
-        int numInputBuses = plugin->getBusCount(true);
-        int numOutputBuses = plugin->getBusCount(false);
-        if (debugLogging.load())
-            std::cerr << "[RACK] Plugin has " << numInputBuses << " input buses, "
-                      << numOutputBuses << " output buses" << std::endl << std::flush;
+    UnifiedPluginDescription unifiedDescriptionFor(const CLAPPluginDescription& desc)
+    {
+        UnifiedPluginDescription unified;
+        unified.format = UnifiedPluginDescription::Format::CLAP;
+        unified.name = desc.name;
+        unified.pluginId = desc.pluginId;
+        unified.pluginPath = desc.pluginPath;
+        unified.vendor = desc.vendor;
+        unified.isInstrument = desc.isInstrument;
+        unified.clapDesc = desc;
+        return unified;
+    }
 
-        if (numInputBuses > 1)
-        {
-            auto* pluginSidechain = plugin->getBus(true, 1);
-            if (pluginSidechain != nullptr)
-            {
-                if (debugLogging.load())
-                    std::cerr << "[RACK] Enabling sidechain bus on hosted plugin" << std::endl << std::flush;
-                pluginSidechain->enable(true);
-            }
-        }
+    // Pad channels a slot's scratch needs: one per VST3 plugin channel (see SlotScratch::padBuffer)
+    int padChannelsFor(const EffectSlot& slot)
+    {
+        if (slot.vst3Plugin == nullptr)
+            return 0;
+        return juce::jmax(slot.vst3Plugin->getTotalNumInputChannels(), slot.vst3Plugin->getTotalNumOutputChannels());
+    }
+}
 
-        if (debugLogging.load())
-            std::cerr << "[RACK] Plugin total channels: "
-                      << plugin->getTotalNumInputChannels() << " in, "
-                      << plugin->getTotalNumOutputChannels() << " out" << std::endl << std::flush;
+std::shared_ptr<EffectSlot> UhbikWrapperAudioProcessor::addLoadingSlot(const UnifiedPluginDescription& description)
+{
+    auto placeholder = std::make_shared<EffectSlot>();
+    placeholder->description = description;
+    placeholder->loading = true;
 
-        double sr = getSampleRate() > 0 ? getSampleRate() : 44100.0;
-        int bs = getBlockSize() > 0 ? getBlockSize() : 512;
+    effectChain.push_back(placeholder);
+    publishChain();
+    sendChangeMessage();
+    return placeholder;
+}
 
+void UhbikWrapperAudioProcessor::finishLoadingSlot(const std::shared_ptr<EffectSlot>& placeholder,
+                                                   std::shared_ptr<EffectSlot> loaded)
+{
+    auto it = std::find(effectChain.begin(), effectChain.end(), placeholder);
+    if (it == effectChain.end())
+    {
+        // Removed (or the chain was cleared / restored) while loading
         if (debugLogging.load())
-            std::cerr << "[RACK] Preparing with SR=" << sr << " BS=" << bs << std::endl << std::flush;
-        plugin->prepareToPlay(sr, bs);
-        if (debugLogging.load())
-            std::cerr << "[RACK] Plugin prepared successfully" << std::endl << std::flush;
-
-        EffectSlot slot;
-        slot.vst3Plugin = std::move(plugin);
-        slot.description.format = UnifiedPluginDescription::Format::VST3;
-        slot.description.name = desc.name;
-        slot.description.pluginId = desc.uniqueId != 0 ? juce::String(desc.uniqueId) : desc.fileOrIdentifier;
-        slot.description.pluginPath = desc.fileOrIdentifier;
-        slot.description.vendor = desc.manufacturerName;
-        slot.description.isInstrument = desc.isInstrument;
-        slot.description.vst3Desc = desc;
-        slot.bypassed = false;
-        slot.ready.store(true);
+            std::cerr << "[RACK] Dropping plugin loaded for a removed slot: " << placeholder->description.name << std::endl << std::flush;
+        return;
+    }
+
+    if (loaded == nullptr)
+    {
+        effectChain.erase(it);
+        retargetModulationRoutes();
+    }
+    else
+    {
+        // Keep whatever was set on the placeholder while it loaded
+        loaded->description = placeholder->description;
+        loaded->bypassed.store(placeholder->bypassed.load());
+        loaded->parallelWithPrevious = placeholder->parallelWithPrevious;
+        loaded->inputGainDb.store(placeholder->inputGainDb.load());
+        loaded->outputGainDb.store(placeholder->outputGainDb.load());
+        loaded->mixPercent.store(placeholder->mixPercent.load());
+        scratch.prepareSlot(loaded->scratch, loaded->processesDouble, padChannelsFor(*loaded));
+        loaded->ready.store(true);
+
+        *it = std::move(loaded);
+    }
+
+    publishChain();
+
+    if (debugLogging.load())
+        std::cerr << "[RACK] Slot load finished. Chain size: " << effectChain.size() << std::endl << std::flush;
+
+    sendChangeMessage();
+}
 
+void UhbikWrapperAudioProcessor::negotiatePlugin(EffectSlot& slot)
+{
+    const bool chainUsesDouble = isUsingDoublePrecision();
+    const auto mainLayout = getChannelLayoutOfBus(false, 0);
+    juce::String pluginName;
+
+    if (slot.vst3Plugin != nullptr)
+    {
+        auto& plugin = *slot.vst3Plugin;
+
+        // Offer the wrapper's main layout, then the same number of discrete
+        // channels. A plugin that takes neither keeps its own (usually stereo).
+        if (plugin.getBusCount(true) > 0 && plugin.getBusCount(false) > 0
+            && (plugin.getChannelLayoutOfBus(true, 0) != mainLayout || plugin.getChannelLayoutOfBus(false, 0) != mainLayout))
         {
-            const juce::SpinLock::ScopedLockType lock(chainLock);
-            effectChain.push_back(std::move(slot));
+            auto layout = plugin.getBusesLayout();
+            layout.getChannelSet(true, 0) = mainLayout;
+            layout.getChannelSet(false, 0) = mainLayout;
+
+            if (!plugin.setBusesLayout(layout))
+            {
+                const auto discrete = juce::AudioChannelSet::discreteChannels(mainLayout.size());
+                layout.getChannelSet(true, 0) = discrete;
+                layout.getChannelSet(false, 0) = discrete;
+                plugin.setBusesLayout(layout);
+            }
         }
 
-        if (debugLogging.load())
-            std::cerr << "[RACK] VST3 plugin added. Chain size: " << effectChain.size() << std::endl << std::flush;
+        slot.pluginMainChannels = plugin.getMainBusNumOutputChannels();
+        slot.processesDouble = chainUsesDouble && plugin.supportsDoublePrecisionProcessing();
+        plugin.setProcessingPrecision(slot.processesDouble ? doublePrecision : singlePrecision);
+        pluginName = plugin.getName();
+    }
+    else if (slot.clapPlugin != nullptr)
+    {
+        slot.pluginMainChannels = static_cast<int>(slot.clapPlugin->getMainOutputChannels());
+        slot.processesDouble = chainUsesDouble && slot.clapPlugin->supportsDoublePrecision();
+        pluginName = slot.clapPlugin->getName();
     }
     else
     {
-        if (debugLogging.load())
-            std::cerr << "[RACK] Failed to create VST3 plugin: " << errorMsg << std::endl << std::flush;
+        slot.processesDouble = false;
     }
 
-    sendChangeMessage();
+    if (debugLogging.load())
+        std::cerr << "[RACK] " << pluginName << ": " << slot.pluginMainChannels << " of " << mainLayout.size()
+                  << " main channels, " << (slot.processesDouble ? "double" : "float")
+                  << (chainUsesDouble && !slot.processesDouble ? " (converted at the slot)" : "") << std::endl << std::flush;
 }
 
-void UhbikWrapperAudioProcessor::addPlugin(const CLAPPluginDescription& desc)
+bool UhbikWrapperAudioProcessor::activateCLAP(CLAPPluginInstance& plugin, double sampleRate, int blockSize)
+{
+    plugin.setPreferredMainChannels(static_cast<uint32_t>(juce::jmax(1, getMainBusNumOutputChannels())));
+
+    // Room for every route at every control point of the largest block (as ModulationEngine counts them)
+    const int maxControlPoints = juce::jmax(0, blockSize) / ModulationEngine::MOD_BLOCK_SIZE + 1;
+    plugin.setMaxModulationEvents(static_cast<size_t>(CLAPPluginInstance::MAX_MODULATION_ROUTES * maxControlPoints));
+
+    return plugin.activate(sampleRate, 1, static_cast<uint32_t>(blockSize));
+}
+
+void UhbikWrapperAudioProcessor::addPlugin(const juce::PluginDescription& desc)
 {
     if (debugLogging.load())
-        std::cerr << "[RACK] Adding CLAP plugin: " << desc.name << std::endl << std::flush;
+        std::cerr << "[RACK] Adding VST3 plugin: " << desc.name << std::endl << std::flush;
 
-    auto clapPlugin = std::make_unique<CLAPPluginInstance>(desc);
+    auto placeholder = addLoadingSlot(unifiedDescriptionFor(desc));
+    juce::WeakReference<UhbikWrapperAudioProcessor> weakThis(this);
 
-    if (!clapPlugin->load())
+    // JUCE's VST3 format has no asynchronous instantiation (its async call
+    // runs inline), and VST3 expects the main thread anyway. So, like CLAP,
+    // instantiation and prepare run as two separate message-thread callbacks
+    // queued behind the placeholder's change message, with a repaint possible
+    // in between.
+    juce::MessageManager::callAsync([weakThis, placeholder, desc]()
     {
-        if (debugLogging.load())
-            std::cerr << "[RACK] Failed to load CLAP plugin" << std::endl << std::flush;
-        sendChangeMessage();
-        return;
-    }
-
-    double sr = getSampleRate() > 0 ? getSampleRate() : 44100.0;
-    int bs = getBlockSize() > 0 ? getBlockSize() : 512;
+        auto* self = weakThis.get();
+        if (self == nullptr)
+            return;
+
+        // Removed before it started loading
+        if (std::find(self->effectChain.begin(), self->effectChain.end(), placeholder) == self->effectChain.end())
+            return;
+
+        // Shared holder, as the callback has to be copyable
+        juce::String errorMsg;
+        auto plugin = std::make_shared<std::unique_ptr<juce::AudioPluginInstance>>(
+            self->pluginFormatManager.createPluginInstance(desc,
+                                                           self->getSampleRate() > 0 ? self->getSampleRate() : 44100.0,
+                                                           self->getBlockSize() > 0 ? self->getBlockSize() : 512,
+                                                           errorMsg));
+
+        juce::MessageManager::callAsync([weakThis, placeholder, plugin, errorMsg]()
+        {
+            if (auto* self = weakThis.get())
+                self->finishVST3Load(placeholder, std::move(*plugin), errorMsg);
+        });
+    });
+}
 
-    if (!clapPlugin->activate(sr, 1, static_cast<uint32_t>(bs)))
+void UhbikWrapperAudioProcessor::finishVST3Load(const std::shared_ptr<EffectSlot>& placeholder,
+                                                std::unique_ptr<juce::AudioPluginInstance> plugin,
+                                                const juce::String& errorMsg)
+{
+    if (plugin == nullptr)
     {
         if (debugLogging.load())
-            std::cerr << "[RACK] Failed to activate CLAP plugin" << std::endl << std::flush;
-        sendChangeMessage();
+            std::cerr << "[RACK] Failed to create VST3 plugin: " << errorMsg << std::endl << std::flush;
+        finishLoadingSlot(placeholder, nullptr);
         return;
     }
 
-    EffectSlot slot;
-    slot.clapPlugin = std::move(clapPlugin);
-    slot.description.format = UnifiedPluginDescription::Format::CLAP;
-    slot.description.name = desc.name;
-    slot.description.pluginId = desc.pluginId;
-    slot.description.pluginPath = desc.pluginPath;
-    slot.description.vendor = desc.vendor;
-    slot.description.isInstrument = desc.isInstrument;
-    slot.description.clapDesc = desc;
-    slot.bypassed = false;
-    slot.ready.store(true);
+    if (debugLogging.load())
+        std::cerr << "[RACK] Plugin created, configuring buses..." << std::endl << std::flush;
+
+    int numInputBuses = plugin->getBusCount(true);
+    int numOutputBuses = plugin->getBusCount(false);
+    if (debugLogging.load())
+        std::cerr << "[RACK] Plugin has " << numInputBuses << " input buses, "
+                  << numOutputBuses << " output buses" << std::endl << std::flush;
 
+    if (numInputBuses > 1)
     {
-        const juce::SpinLock::ScopedLockType lock(chainLock);
-        effectChain.push_back(std::move(slot));
+        auto* pluginSidechain = plugin->getBus(true, 1);
+        if (pluginSidechain != nullptr)
+        {
+            if (debugLogging.load())
+                std::cerr << "[RACK] Enabling sidechain bus on hosted plugin" << std::endl << std::flush;
+            pluginSidechain->enable(true);
+        }
     }
 
     if (debugLogging.load())
-        std::cerr << "[RACK] CLAP plugin added. Chain size: " << effectChain.size() << std::endl << std::flush;
+        std::cerr << "[RACK] Plugin total channels: "
+                  << plugin->getTotalNumInputChannels() << " in, "
+                  << plugin->getTotalNumOutputChannels() << " out" << std::endl << std::flush;
 
-    sendChangeMessage();
+    // The host may have re-prepared us while the plugin was loading
+    double sr = getSampleRate() > 0 ? getSampleRate() : 44100.0;
+    int bs = getBlockSize() > 0 ? getBlockSize() : 512;
+
+    auto slot = std::make_shared<EffectSlot>();
+    slot->vst3Plugin = std::move(plugin);
+    negotiatePlugin(*slot);
+
+    if (debugLogging.load())
+        std::cerr << "[RACK] Preparing with SR=" << sr << " BS=" << bs << std::endl << std::flush;
+    slot->vst3Plugin->prepareToPlay(sr, bs);
+    if (debugLogging.load())
+        std::cerr << "[RACK] Plugin prepared successfully" << std::endl << std::flush;
+
+    finishLoadingSlot(placeholder, std::move(slot));
+}
+
+void UhbikWrapperAudioProcessor::addPlugin(const CLAPPluginDescription& desc)
+{
+    if (debugLogging.load())
+        std::cerr << "[RACK] Adding CLAP plugin: " << desc.name << std::endl << std::flush;
+
+    auto placeholder = addLoadingSlot(unifiedDescriptionFor(desc));
+    juce::WeakReference<UhbikWrapperAudioProcessor> weakThis(this);
+
+    // CLAP only allows load and activate on the main thread, so they run as two
+    // separate message-thread callbacks with a repaint possible in between
+    juce::MessageManager::callAsync([weakThis, placeholder, desc]()
+    {
+        auto* self = weakThis.get();
+        if (self == nullptr)
+            return;
+
+        auto slot = std::make_shared<EffectSlot>();
+        slot->clapPlugin = std::make_unique<CLAPPluginInstance>(desc);
+
+        if (!slot->clapPlugin->load())
+        {
+            if (self->debugLogging.load())
+                std::cerr << "[RACK] Failed to load CLAP plugin" << std::endl << std::flush;
+            self->finishLoadingSlot(placeholder, nullptr);
+            return;
+        }
+
+        juce::MessageManager::callAsync([weakThis, placeholder, slot]()
+        {
+            auto* self = weakThis.get();
+            if (self == nullptr)
+                return;
+
+            // The host may have re-prepared us while the plugin was loading
+            double sr = self->getSampleRate() > 0 ? self->getSampleRate() : 44100.0;
+            int bs = self->getBlockSize() > 0 ? self->getBlockSize() : 512;
+
+            if (!self->activateCLAP(*slot->clapPlugin, sr, bs))
+            {
+                if (self->debugLogging.load())
+                    std::cerr << "[RACK] Failed to activate CLAP plugin" << std::endl << std::flush;
+                self->finishLoadingSlot(placeholder, nullptr);
+                return;
+            }
+
+            self->negotiatePlugin(*slot);
+            self->finishLoadingSlot(placeholder, slot);
+        });
+    });
 }
 
 void UhbikWrapperAudioProcessor::addPlugin(const UnifiedPluginDescription& desc)
@@ -323,10 +998,10 @@ void UhbikWrapperAudioProcessor::removePlugin(int index)
         return;
     }
 
-    {
-        const juce::SpinLock::ScopedLockType lock(chainLock);
-        effectChain.erase(effectChain.begin() + index);
-    }
+    // The removed plugin is destroyed once the audio thread has let go of it
+    effectChain.erase(effectChain.begin() + index);
+    retargetModulationRoutes();
+    publishChain();
 
     if (debugLogging.load())
         std::cerr << "[RACK] Plugin removed. Chain size: " << effectChain.size() << std::endl << std::flush;
@@ -339,10 +1014,11 @@ void UhbikWrapperAudioProcessor::movePlugin(int fromIndex, int toIndex)
         toIndex >= 0 && toIndex < static_cast<int>(effectChain.size()) &&
         fromIndex != toIndex)
     {
-        const juce::SpinLock::ScopedLockType lock(chainLock);
         auto slot = std::move(effectChain[static_cast<size_t>(fromIndex)]);
         effectChain.erase(effectChain.begin() + fromIndex);
         effectChain.insert(effectChain.begin() + toIndex, std::move(slot));
+        retargetModulationRoutes();
+        publishChain();
         sendChangeMessage();
     }
 }
@@ -352,10 +1028,9 @@ void UhbikWrapperAudioProcessor::clearChain()
     if (debugLogging.load())
         std::cerr << "[RACK] clearChain called. Current size: " << effectChain.size() << std::endl << std::flush;
 
-    {
-        const juce::SpinLock::ScopedLockType lock(chainLock);
-        effectChain.clear();
-    }
+    effectChain.clear();
+    retargetModulationRoutes();
+    publishChain();
 
     if (debugLogging.load())
         std::cerr << "[RACK] Chain cleared. New size: " << effectChain.size() << std::endl << std::flush;
@@ -366,16 +1041,44 @@ void UhbikWrapperAudioProcessor::setPluginBypassed(int index, bool bypassed)
 {
     if (index >= 0 && index < static_cast<int>(effectChain.size()))
     {
-        effectChain[static_cast<size_t>(index)].bypassed = bypassed;
+        effectChain[static_cast<size_t>(index)]->bypassed.store(bypassed);
+        sendChangeMessage();
+    }
+}
+
+void UhbikWrapperAudioProcessor::setSlotParallel(int index, bool parallelWithPrevious)
+{
+    if (index >= 0 && index < static_cast<int>(effectChain.size()))
+    {
+        effectChain[static_cast<size_t>(index)]->parallelWithPrevious = parallelWithPrevious;
+        publishChain();
         sendChangeMessage();
     }
 }
 
+void UhbikWrapperAudioProcessor::setNumWorkerThreads(int numThreads)
+{
+    workerPool.setNumWorkers(numThreads);
+    publishChain();  // The pipeline uses one stage per thread
+
+    if (debugLogging.load())
+        std::cerr << "[RACK] Worker threads: " << workerPool.getNumWorkers() << std::endl << std::flush;
+}
+
+void UhbikWrapperAudioProcessor::setPipelinedChain(bool shouldPipeline)
+{
+    pipelinedChain = shouldPipeline;
+    publishChain();
+
+    if (debugLogging.load())
+        std::cerr << "[RACK] Pipelined chain: " << (pipelinedChain ? "on" : "off") << std::endl << std::flush;
+}
+
 void UhbikWrapperAudioProcessor::setSlotInputGain(int index, float gainDb)
 {
     if (index >= 0 && index < static_cast<int>(effectChain.size()))
     {
-        effectChain[static_cast<size_t>(index)].inputGainDb.store(juce::jlimit(-24.0f, 24.0f, gainDb));
+        effectChain[static_cast<size_t>(index)]->inputGainDb.store(juce::jlimit(-24.0f, 24.0f, gainDb));
     }
 }
 
@@ -383,7 +1086,7 @@ void UhbikWrapperAudioProcessor::setSlotOutputGain(int index, float gainDb)
 {
     if (index >= 0 && index < static_cast<int>(effectChain.size()))
     {
-        effectChain[static_cast<size_t>(index)].outputGainDb.store(juce::jlimit(-24.0f, 24.0f, gainDb));
+        effectChain[static_cast<size_t>(index)]->outputGainDb.store(juce::jlimit(-24.0f, 24.0f, gainDb));
     }
 }
 
@@ -391,7 +1094,7 @@ void UhbikWrapperAudioProcessor::setSlotMix(int index, float mixPercent)
 {
     if (index >= 0 && index < static_cast<int>(effectChain.size()))
     {
-        effectChain[static_cast<size_t>(index)].mixPercent.store(juce::jlimit(0.0f, 100.0f, mixPercent));
+        effectChain[static_cast<size_t>(index)]->mixPercent.store(juce::jlimit(0.0f, 100.0f, mixPercent));
     }
 }
 
@@ -399,7 +1102,7 @@ juce::AudioPluginInstance* UhbikWrapperAudioProcessor::getPluginAt(int index)
 {
     if (index >= 0 && index < static_cast<int>(effectChain.size()))
     {
-        return effectChain[static_cast<size_t>(index)].vst3Plugin.get();
+        return effectChain[static_cast<size_t>(index)]->vst3Plugin.get();
     }
     return nullptr;
 }
@@ -408,8 +1111,8 @@ void UhbikWrapperAudioProcessor::closeAllCLAPEditors()
 {
     for (auto& slot : effectChain)
     {
-        if (slot.clapPlugin)
-            slot.clapPlugin->closeEditor();
+        if (slot->clapPlugin)
+            slot->clapPlugin->closeEditor();
     }
 }
 
@@ -438,7 +1141,7 @@ void UhbikWrapperAudioProcessor::addModulationRoute(ModSourceType sourceType, in
         return;
 
     // Only CLAP plugins support modulation
-    auto& slot = effectChain[static_cast<size_t>(slotIndex)];
+    auto& slot = *effectChain[static_cast<size_t>(slotIndex)];
     if (!slot.isCLAP() || slot.clapPlugin == nullptr)
         return;
 
@@ -460,22 +1163,34 @@ void UhbikWrapperAudioProcessor::addModulationRoute(ModSourceType sourceType, in
     if (!found)
         return;
 
+    // The plugin's modulation lane is sized for this many routes
+    const auto instanceId = slot.clapPlugin->getInstanceId();
+    const auto numSlotRoutes = std::count_if(modulationRoutes.begin(), modulationRoutes.end(),
+                                             [instanceId](const ModulationRoute& r) { return r.target.pluginInstanceId == instanceId; });
+    if (numSlotRoutes >= CLAPPluginInstance::MAX_MODULATION_ROUTES)
+    {
+        std::cerr << "[RACK] Modulation route limit (" << CLAPPluginInstance::MAX_MODULATION_ROUTES
+                  << ") reached for " << slot.description.name << std::endl;
+        return;
+    }
+
     ModulationRoute route;
     route.sourceType = sourceType;
     route.sourceIndex = sourceIndex;
     route.target.slotIndex = slotIndex;
+    route.target.pluginInstanceId = instanceId;
     route.target.paramId = paramId;
     route.target.paramName = targetParam.name;
     route.target.minValue = targetParam.minValue;
     route.target.maxValue = targetParam.maxValue;
     route.target.isModulatable = true;
+    route.target.cookie = targetParam.cookie;
+    route.target.cookieGeneration = slot.clapPlugin->getCookieGeneration();
     route.amount = juce::jlimit(-1.0f, 1.0f, amount);
     route.enabled = true;
 
-    {
-        const juce::SpinLock::ScopedLockType lock(modulationLock);
-        modulationRoutes.push_back(route);
-    }
+    modulationRoutes.push_back(route);
+    publishChain();
 
     if (debugLogging.load())
         std::cerr << "[RACK] Added modulation: " << route.getSourceName() << " -> " << targetParam.name << std::endl;
@@ -485,28 +1200,37 @@ void UhbikWrapperAudioProcessor::addModulationRoute(ModSourceType sourceType, in
 
 void UhbikWrapperAudioProcessor::removeModulationRoute(int routeIndex)
 {
-    const juce::SpinLock::ScopedLockType lock(modulationLock);
-    if (routeIndex >= 0 && routeIndex < static_cast<int>(modulationRoutes.size()))
-    {
-        modulationRoutes.erase(modulationRoutes.begin() + routeIndex);
-        sendChangeMessage();
-    }
+    if (routeIndex < 0 || routeIndex >= static_cast<int>(modulationRoutes.size()))
+        return;
+
+    modulationRoutes.erase(modulationRoutes.begin() + routeIndex);
+    publishChain();
+    sendChangeMessage();
 }
 
 void UhbikWrapperAudioProcessor::clearModulationRoutes()
 {
-    const juce::SpinLock::ScopedLockType lock(modulationLock);
     modulationRoutes.clear();
+    publishChain();
     sendChangeMessage();
 }
 
 void UhbikWrapperAudioProcessor::setModulationAmount(int routeIndex, float amount)
 {
-    const juce::SpinLock::ScopedLockType lock(modulationLock);
-    if (routeIndex >= 0 && routeIndex < static_cast<int>(modulationRoutes.size()))
-    {
-        modulationRoutes[static_cast<size_t>(routeIndex)].amount = juce::jlimit(-1.0f, 1.0f, amount);
-    }
+    if (routeIndex < 0 || routeIndex >= static_cast<int>(modulationRoutes.size()))
+        return;
+
+    modulationRoutes[static_cast<size_t>(routeIndex)].amount = juce::jlimit(-1.0f, 1.0f, amount);
+    publishChain();
+}
+
+bool UhbikWrapperAudioProcessor::getReportedCLAPParameterValue(int slotIndex, clap_id paramId, double& value) const
+{
+    if (slotIndex < 0 || slotIndex >= static_cast<int>(effectChain.size()))
+        return false;
+
+    const auto* clap = effectChain[static_cast<size_t>(slotIndex)]->clapPlugin.get();
+    return clap != nullptr && clap->getReportedParameterValue(paramId, value);
 }
 
 std::vector<CLAPParameterInfo> UhbikWrapperAudioProcessor::getModulatableParametersForSlot(int slotIndex) const
@@ -514,7 +1238,7 @@ std::vector<CLAPParameterInfo> UhbikWrapperAudioProcessor::getModulatableParamet
     if (slotIndex < 0 || slotIndex >= static_cast<int>(effectChain.size()))
         return {};
 
-    const auto& slot = effectChain[static_cast<size_t>(slotIndex)];
+    const auto& slot = *effectChain[static_cast<size_t>(slotIndex)];
     if (!slot.isCLAP() || slot.clapPlugin == nullptr)
         return {};
 
@@ -703,11 +1427,23 @@ void UhbikWrapperAudioProcessor::changeProgramName (int index, const juce::Strin
 
 void UhbikWrapperAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    const juce::SpinLock::ScopedLockType lock(chainLock);
+    // processBlock isn't running, so we can borrow its hold on the published chain
+    auto* chain = acquireChain();
 
     currentSampleRate = sampleRate;
-    duckerEnvelope = 0.0f;
-    duckerHoldCounter = 0.0f;
+
+    // Size all audio-thread scratch memory up front, in the host's precision
+    // (set before prepareToPlay)
+    const bool hostUsesDouble = isUsingDoublePrecision();
+    const int numMainChannels = juce::jmax(1, getMainBusNumOutputChannels());
+    scratch.prepare(numMainChannels, samplesPerBlock, sampleRate, hostUsesDouble);
+    masterInputGain.prepare(scratch.getGainRampSamples());
+    masterOutputGain.prepare(scratch.getGainRampSamples());
+    masterWetMix.prepare(scratch.getGainRampSamples());
+    modulationEngine.prepare(samplesPerBlock);
+    ducker.prepare(sampleRate, samplesPerBlock, scratch.getNumMainChannels(), hostUsesDouble);
+    activePipelineStages.clear();
+    activePipelineStages.reserve(RealtimeScratch::MAX_PIPELINE_STAGES);
 
     // Prepare LFOs
     for (int i = 0; i < NUM_LFOS; ++i)
@@ -732,13 +1468,21 @@ void UhbikWrapperAudioProcessor::prepareToPlay (double sampleRate, int samplesPe
 
     // Always log prepareToPlay for debugging
     std::cerr << "[RACK] prepareToPlay: SR=" << sampleRate << " BS=" << samplesPerBlock
-              << " sidechain=" << (wrapperHasSidechain ? "CONNECTED" : "not connected") << std::endl;
+              << " main=" << getChannelLayoutOfBus(false, 0).getDescription()
+              << " sidechain=" << (wrapperHasSidechain ? "CONNECTED" : "not connected")
+              << " precision=" << (hostUsesDouble ? "double" : "float") << std::endl;
     std::cerr.flush();
 
-    for (auto& slot : effectChain)
+    for (auto& slotPtr : chain->slots)
     {
+        auto& slot = *slotPtr;
+
         if (slot.vst3Plugin != nullptr)
         {
+            // The host's layout or precision may have changed since the plugin
+            // was prepared, and a plugin only takes a new layout while released
+            slot.vst3Plugin->releaseResources();
+            negotiatePlugin(slot);
             slot.vst3Plugin->prepareToPlay(sampleRate, samplesPerBlock);
         }
         else if (slot.clapPlugin != nullptr)
@@ -749,33 +1493,42 @@ void UhbikWrapperAudioProcessor::prepareToPlay (double sampleRate, int samplesPe
             {
                 slot.clapPlugin->deactivate();
             }
-            slot.clapPlugin->activate(sampleRate, 1, static_cast<uint32_t>(samplesPerBlock));
+            activateCLAP(*slot.clapPlugin, sampleRate, samplesPerBlock);
+            negotiatePlugin(slot);
         }
+
+        scratch.prepareSlot(slot.scratch, slot.processesDouble, padChannelsFor(slot));
     }
+
+    // Latency can depend on the sample rate and block size
+    updateLatency(*chain, true);
+
+    releaseChain();
 }
 
 void UhbikWrapperAudioProcessor::releaseResources()
 {
-    const juce::SpinLock::ScopedLockType lock(chainLock);
-    for (auto& slot : effectChain)
+    auto* chain = acquireChain();
+    for (auto& slot : chain->slots)
     {
-        if (slot.vst3Plugin != nullptr)
+        if (slot->vst3Plugin != nullptr)
         {
-            slot.vst3Plugin->releaseResources();
+            slot->vst3Plugin->releaseResources();
         }
-        else if (slot.clapPlugin != nullptr)
+        else if (slot->clapPlugin != nullptr)
         {
-            slot.clapPlugin->deactivate();
+            slot->clapPlugin->deactivate();
         }
     }
+    releaseChain();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool UhbikWrapperAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
-    // Main output must be mono or stereo
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Main output can be any layout up to MAX_MAIN_CHANNELS (mono, stereo, surround, discrete)
+    const auto mainLayout = layouts.getMainOutputChannelSet();
+    if (mainLayout.isDisabled() || mainLayout.size() > RealtimeScratch::MAX_MAIN_CHANNELS)
         return false;
 
     // Main input must match main output
@@ -798,377 +1551,574 @@ bool UhbikWrapperAudioProcessor::isBusesLayoutSupported (const BusesLayout& layo
 
 void UhbikWrapperAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-    static int processCallCount = 0;
-    if (processCallCount < 5)
-    {
-        std::cerr << "[RACK] processBlock #" << processCallCount << " samples=" << buffer.getNumSamples() << std::endl << std::flush;
-        processCallCount++;
-    }
+    processBlockInPrecision(buffer, midiMessages);
+}
+
+void UhbikWrapperAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processBlockInPrecision(buffer, midiMessages);
+}
+
+template <typename SampleType>
+void UhbikWrapperAudioProcessor::processBlockInPrecision(juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages)
+{
+    // The host switches precision only around prepareToPlay
+    jassert(scratch.isDoublePrecision() == std::is_same_v<SampleType, double>);
+
+    ScopedAudioThread audioThreadScope;
+    juce::ScopedNoDenormals noDenormals;
+    const auto blockStartTicks = juce::Time::getHighResolutionTicks();
+    parallelSavedTicks = 0;
+    auto totalNumInputChannels  = getTotalNumInputChannels();
+    auto totalNumOutputChannels = getTotalNumOutputChannels();
+
+    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
+        buffer.clear (i, 0, buffer.getNumSamples());
+
+    // Pick up the latest published chain. Edits on the message thread publish a
+    // new snapshot instead of locking, so this never has to skip a block.
+    const ChainSnapshot& chain = *acquireChain();
+
+    // Scratch buffers are sized for the block size given to prepareToPlay.
+    // If the host sends more than that, process in chunks rather than growing them.
+    const int maxBlockSize = scratch.getMaxBlockSize();
+    const int totalSamples = buffer.getNumSamples();
+    if (totalSamples <= maxBlockSize)
+    {
+        processChunk(chain, buffer, midiMessages);
+    }
+    else
+    {
+        for (int start = 0; start < totalSamples; start += maxBlockSize)
+        {
+            const int chunkSamples = juce::jmin(maxBlockSize, totalSamples - start);
+            juce::AudioBuffer<SampleType> chunk(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, chunkSamples);
+            processChunk(chain, chunk, scratch.getChunkMidi(midiMessages, start, chunkSamples));
+        }
+    }
+
+    releaseChain();
+
+    // DSP load for the footer display, smoothed over roughly 20 blocks
+    const double blockSeconds = totalSamples / currentSampleRate;
+    if (blockSeconds > 0.0)
+    {
+        const auto elapsedTicks = juce::Time::getHighResolutionTicks() - blockStartTicks;
+        const auto load = static_cast<float>(juce::Time::highResolutionTicksToSeconds(elapsedTicks) / blockSeconds);
+        const auto serialLoad = static_cast<float>(juce::Time::highResolutionTicksToSeconds(elapsedTicks + parallelSavedTicks) / blockSeconds);
+        cpuLoad.store(cpuLoad.load() + 0.05f * (load - cpuLoad.load()));
+        serialCpuLoad.store(serialCpuLoad.load() + 0.05f * (serialLoad - serialCpuLoad.load()));
+    }
+}
+
+template <typename SampleType>
+void UhbikWrapperAudioProcessor::processChunk(const ChainSnapshot& chain, juce::AudioBuffer<SampleType>& buffer,
+                                              juce::MidiBuffer& midiMessages)
+{
+    // Get parameter values (cached pointers - no string lookup on the audio thread)
+    masterInputGain.setTarget(juce::Decibels::decibelsToGain(inputGainParam->load()));
+    masterOutputGain.setTarget(juce::Decibels::decibelsToGain(outputGainParam->load()));
+    masterWetMix.setTarget(mixParam->load() / 100.0f);
+
+    // Check if we have sidechain input (channels after the main bus)
+    const int numBufferChannels = buffer.getNumChannels();
+    const int mainChannels = scratch.getNumMainChannels();
+    const bool hasSidechainInput = (numBufferChannels > mainChannels);
+    const int numSamples = buffer.getNumSamples();
+
+    // Store dry signal for mix, delayed by the chain's total latency so it lines up
+    // with the wet signal. Always written so the delay history stays continuous.
+    const int chainLatency = getChainLatency(chain);
+
+    auto& dryBuffer = scratch.getMasterDryBuffer<SampleType>();
+    scratch.getMasterDryDelay().process(buffer, dryBuffer, juce::jmin(mainChannels, numBufferChannels),
+                                        numSamples, chainLatency);
+
+    // Apply input gain to main channels only, measuring the result in the same pass
+    const int numMainChannels = juce::jmin(mainChannels, numBufferChannels);
+    ChannelLevels levels[RealtimeScratch::MAX_MAIN_CHANNELS];
+
+    GainMixKernel::process(buffer.getArrayOfWritePointers(), nullptr, numMainChannels, numSamples,
+                           masterInputGain.next(numSamples), GainRamp(), levels);
+    masterInputRms.store(updateLevelMeters(masterInputLevelL, masterInputLevelR, levels, numMainChannels));
+
+    // Render every modulation source once for this block - all slots share the result
+    modulationEngine.render(lfos, envelopes, stepSequencers, macroParams, numSamples);
+
+    // Process each effect in the chain, one group at a time
+    if (!chain.stages.empty())
+    {
+        processPipelined(chain, buffer, midiMessages);
+    }
+    else
+    {
+        activePipelineStages.clear();
+
+        for (const auto& group : chain.groups)
+        {
+            if (group.count > 1)
+            {
+                processParallelGroup(chain, group, buffer, midiMessages, true);
+                continue;
+            }
+
+            auto& slot = *chain.slots[group.first];
+            if (slot.hasPlugin() && slot.ready.load())
+                processSlot(chain, group.first, buffer, midiMessages, slot.latencySamples.load());
+        }
+    }
+
+    // Apply wet/dry mix (nothing to do at a steady 100% wet)
+    const GainRamp wet = masterWetMix.next(numSamples);
+    if (!wet.isUnity())
+        GainMixKernel::process(buffer.getArrayOfWritePointers(), dryBuffer.getArrayOfReadPointers(),
+                               numMainChannels, numSamples, GainRamp(), wet, nullptr);
+
+    // === DUCKER PROCESSING ===
+    if (duckerEnabled.load())
+    {
+        ducker.setParameters(duckerThresholdDb.load(), duckerAmount.load(), duckerAttackMs.load(),
+                             duckerReleaseMs.load(), duckerHoldMs.load());
+        ducker.setDetector(duckerRmsDetector.load() ? Ducker::Detector::Rms : Ducker::Detector::Peak);
+
+        // Lookahead applies (and is reported) even without a sidechain, so the
+        // latency doesn't jump when the host connects one
+        ducker.setLookahead(getDuckerLatency());
+
+        // Sidechain on the two channels after the main bus (mono key if only one is present)
+        const SampleType* sidechainLeft = hasSidechainInput ? buffer.getReadPointer(mainChannels) : nullptr;
+        const SampleType* sidechainRight = numBufferChannels > mainChannels + 1 ? buffer.getReadPointer(mainChannels + 1) : nullptr;
+
+        // Store gain reduction for UI metering
+        duckerGainReduction.store(ducker.process(buffer.getArrayOfWritePointers(), numMainChannels,
+                                                 sidechainLeft, sidechainRight, numSamples));
+    }
+    else
+    {
+        // Ducker disabled - decay the meter
+        ducker.bypassed();
+        float currentGR = duckerGainReduction.load();
+        if (currentGR > 0.001f)
+            duckerGainReduction.store(currentGR * 0.95f);
+        else
+            duckerGainReduction.store(0.0f);
+    }
+
+    // Apply output gain to main channels and measure the master output
+    GainMixKernel::process(buffer.getArrayOfWritePointers(), nullptr, numMainChannels, numSamples,
+                           masterOutputGain.next(numSamples), GainRamp(), levels);
+    masterOutputRms.store(updateLevelMeters(masterOutputLevelL, masterOutputLevelR, levels, numMainChannels));
+}
+
+template <typename SampleType>
+void UhbikWrapperAudioProcessor::processSlot(const ChainSnapshot& chain, size_t slotIndex, juce::AudioBuffer<SampleType>& buffer,
+                                             juce::MidiBuffer& midiMessages, int slotLatency)
+{
+    auto& slot = *chain.slots[slotIndex];
 
-    juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
+    const int numBufferChannels = buffer.getNumChannels();
+    const int mainChannels = scratch.getNumMainChannels();
+    const int numSamples = buffer.getNumSamples();
 
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear (i, 0, buffer.getNumSamples());
+    // Slot input delayed by the plugin's latency: the dry signal for the
+    // per-slot mix, and what a bypassed slot outputs so the chain's total
+    // latency doesn't change with bypass
+    auto& slotDryBuffer = slot.scratch.dryBuffer.get<SampleType>();
+    slot.scratch.dryDelay.process(buffer, slotDryBuffer, juce::jmin(mainChannels, numBufferChannels),
+                                  numSamples, slotLatency);
 
-    // Try to acquire lock - if chain is being modified, skip this block
-    const juce::SpinLock::ScopedTryLockType lock(chainLock);
-    if (!lock.isLocked())
+    if (slot.bypassed.load())
+    {
+        if (slotLatency > 0)
+        {
+            for (int ch = 0; ch < mainChannels && ch < numBufferChannels; ++ch)
+                buffer.copyFrom(ch, 0, slotDryBuffer, ch, 0, numSamples);
+        }
         return;
+    }
 
-    // Get parameter values
-    float inputGainDb = apvts.getRawParameterValue("inputGain")->load();
-    float outputGainDb = apvts.getRawParameterValue("outputGain")->load();
-    float mixPercent = apvts.getRawParameterValue("mix")->load();
+    // Per-slot mixing parameters, smoothed so knob moves don't zipper
+    auto& gains = slot.scratch;
+    gains.inputGain.setTarget(juce::Decibels::decibelsToGain(slot.inputGainDb.load()));
+    gains.outputGain.setTarget(juce::Decibels::decibelsToGain(slot.outputGainDb.load()));
+    gains.wetMix.setTarget(slot.mixPercent.load() / 100.0f);
+
+    const int numMainChannels = juce::jmin(mainChannels, numBufferChannels);
+    ChannelLevels levels[RealtimeScratch::MAX_MAIN_CHANNELS];
+
+    // Input trim + input meter in one pass
+    const GainRamp inputRamp = gains.inputGain.next(numSamples);
+    GainMixKernel::process(buffer.getArrayOfWritePointers(), nullptr, numMainChannels, numSamples,
+                           inputRamp, GainRamp(), levels);
+    updateLevelMeters(slot.inputLevelL, slot.inputLevelR, levels, numMainChannels);
+
+    // Skip the plugin while its input is silent and it has rung out. MIDI, or
+    // a CLAP plugin asking to be processed, counts as input. CLAP plugins also
+    // get the constant channels (constant_mask) from the same pass.
+    auto& silence = slot.scratch.silence;
+    bool inputSilent = false;
+    uint64_t constantChannels = 0;
+    if (slot.isCLAP())
+    {
+        const bool wakeRequested = slot.clapPlugin->consumeProcessRequest();
+        bool bufferSilent = false;
+        constantChannels = SilenceTracker::findConstantChannels(buffer.getArrayOfReadPointers(), numBufferChannels,
+                                                                numSamples, bufferSilent);
+        inputSilent = !wakeRequested && midiMessages.isEmpty() && bufferSilent;
+    }
+    else
+    {
+        inputSilent = midiMessages.isEmpty()
+                      && SilenceTracker::isSilent(buffer.getArrayOfReadPointers(), numBufferChannels, numSamples);
+    }
 
-    float inputGain = juce::Decibels::decibelsToGain(inputGainDb);
-    float outputGain = juce::Decibels::decibelsToGain(outputGainDb);
-    float wetMix = mixPercent / 100.0f;
-    float dryMix = 1.0f - wetMix;
+    // Process either VST3 or CLAP plugin
+    if (!silence.shouldProcess(inputSilent))
+    {
+        // Asleep: the plugin's output would be as silent as the buffer already is
+        if (slot.isCLAP())
+            slot.clapPlugin->suspendProcessing();
+    }
+    else if constexpr (std::is_same_v<SampleType, double>)
+    {
+        if (slot.processesDouble)
+        {
+            processPlugin(chain, slotIndex, buffer, midiMessages, slotLatency, inputSilent, constantChannels);
+        }
+        else
+        {
+            // Float-only plugin in a double chain: it runs on a float copy of
+            // the slot input. This is the only place the chain converts.
+            auto& convertBuffer = slot.scratch.convertBuffer;
+            const int convertChannels = convertBuffer.getNumChannels();
+            juce::AudioBuffer<float> floatBuffer(convertBuffer.getArrayOfWritePointers(), convertChannels, numSamples);
 
-    // Check if we have sidechain input (buffer has more than 2 channels)
-    const int numBufferChannels = buffer.getNumChannels();
-    const int mainChannels = 2;  // Stereo main
-    const bool hasSidechainInput = (numBufferChannels > mainChannels);
-    const int numSamples = buffer.getNumSamples();
+            for (int ch = 0; ch < convertChannels; ++ch)
+            {
+                if (ch < numBufferChannels)
+                    SampleConversion::convert(floatBuffer.getWritePointer(ch), buffer.getReadPointer(ch), numSamples);
+                else
+                    floatBuffer.clear(ch, 0, numSamples);
+            }
 
-    // Store dry signal for mix
-    juce::AudioBuffer<float> dryBuffer;
-    if (dryMix > 0.0f)
+            processPlugin(chain, slotIndex, floatBuffer, midiMessages, slotLatency, inputSilent, constantChannels);
+            SampleConversion::convert(buffer, floatBuffer, numMainChannels, numSamples);
+        }
+    }
+    else
     {
-        dryBuffer.setSize(mainChannels, numSamples, false, false, true);
-        for (int ch = 0; ch < mainChannels && ch < numBufferChannels; ++ch)
-            dryBuffer.copyFrom(ch, 0, buffer, ch, 0, numSamples);
+        processPlugin(chain, slotIndex, buffer, midiMessages, slotLatency, inputSilent, constantChannels);
     }
 
-    // Apply input gain to main channels only
-    for (int ch = 0; ch < mainChannels && ch < numBufferChannels; ++ch)
-        buffer.applyGain(ch, 0, numSamples, inputGain);
-
-    // Measure master input levels (after input gain)
-    if (numBufferChannels >= 2)
+    // Main channels the plugin doesn't cover (a stereo plugin on a surround
+    // bus) pass through, delayed like the rest of the slot and trimmed
+    if (slot.pluginMainChannels < numMainChannels)
     {
-        float peakL = buffer.getMagnitude(0, 0, numSamples);
-        float peakR = buffer.getMagnitude(1, 0, numSamples);
-        // Simple peak hold with decay
-        float currentL = masterInputLevelL.load();
-        float currentR = masterInputLevelR.load();
-        masterInputLevelL.store(peakL > currentL ? peakL : currentL * 0.95f);
-        masterInputLevelR.store(peakR > currentR ? peakR : currentR * 0.95f);
+        const int firstUncovered = juce::jmax(0, slot.pluginMainChannels);
+        for (int ch = firstUncovered; ch < numMainChannels; ++ch)
+            buffer.copyFrom(ch, 0, slotDryBuffer, ch, 0, numSamples);
+
+        GainMixKernel::process(buffer.getArrayOfWritePointers() + firstUncovered, nullptr,
+                               numMainChannels - firstUncovered, numSamples, inputRamp, GainRamp(), nullptr);
     }
 
-    // Process each effect in the chain
-    juce::AudioBuffer<float> slotDryBuffer(mainChannels, numSamples);
+    // Output gain, wet/dry mix and output meter in one pass (dry path skipped at 100% wet)
+    const GainRamp wet = gains.wetMix.next(numSamples);
+    GainMixKernel::process(buffer.getArrayOfWritePointers(), wet.isUnity() ? nullptr : slotDryBuffer.getArrayOfReadPointers(),
+                           numMainChannels, numSamples, gains.outputGain.next(numSamples), wet, levels);
+    updateLevelMeters(slot.outputLevelL, slot.outputLevelR, levels, numMainChannels);
+}
 
-    for (auto& slot : effectChain)
+template <typename PluginSampleType>
+void UhbikWrapperAudioProcessor::processPlugin(const ChainSnapshot& chain, size_t slotIndex,
+                                               juce::AudioBuffer<PluginSampleType>& buffer, juce::MidiBuffer& midiMessages,
+                                               int slotLatency, bool inputSilent, uint64_t constantChannels)
+{
+    auto& slot = *chain.slots[slotIndex];
+    auto& silence = slot.scratch.silence;
+
+    const int numBufferChannels = buffer.getNumChannels();
+    const int mainChannels = scratch.getNumMainChannels();
+    const int numMainChannels = juce::jmin(mainChannels, numBufferChannels);
+    const int numSamples = buffer.getNumSamples();
+    const int numModPoints = modulationEngine.getNumControlPoints();
+
+    if (slot.isVST3())
     {
-        if (slot.hasPlugin() && slot.ready.load() && !slot.bypassed)
+        // Hand the plugin a buffer laid out like its own buses: main channels
+        // and sidechain point straight into the slot buffer (in place), any
+        // plugin channel without a counterpart gets a silent pad channel
+        constexpr int MAX_PLUGIN_CHANNELS = 32;
+        auto& padBuffer = slot.scratch.padBuffer.get<PluginSampleType>();
+        const int pluginMainInputs = slot.vst3Plugin->getMainBusNumInputChannels();
+        const int pluginInputs = slot.vst3Plugin->getTotalNumInputChannels();
+        const int numPluginChannels = juce::jmin(padBuffer.getNumChannels(), MAX_PLUGIN_CHANNELS);
+
+        PluginSampleType* channelData[MAX_PLUGIN_CHANNELS];
+        for (int ch = 0; ch < numPluginChannels; ++ch)
         {
-            // Get per-slot mixing parameters
-            float slotInputGain = juce::Decibels::decibelsToGain(slot.inputGainDb.load());
-            float slotOutputGain = juce::Decibels::decibelsToGain(slot.outputGainDb.load());
-            float slotMixPct = slot.mixPercent.load();
-            float slotWet = slotMixPct / 100.0f;
-            float slotDry = 1.0f - slotWet;
-
-            // Save dry signal for per-slot mix (only if mix < 100%)
-            if (slotDry > 0.0f)
-            {
-                for (int ch = 0; ch < mainChannels && ch < numBufferChannels; ++ch)
-                    slotDryBuffer.copyFrom(ch, 0, buffer, ch, 0, numSamples);
-            }
+            int bufferChannel = -1;
+            if (ch < pluginMainInputs)
+                bufferChannel = ch < numMainChannels ? ch : -1;
+            else if (ch < pluginInputs)
+                bufferChannel = mainChannels + (ch - pluginMainInputs);  // Sidechain
 
-            // Apply per-slot input gain
-            if (slotInputGain != 1.0f)
+            if (bufferChannel >= 0 && bufferChannel < numBufferChannels)
             {
-                for (int ch = 0; ch < mainChannels && ch < numBufferChannels; ++ch)
-                    buffer.applyGain(ch, 0, numSamples, slotInputGain);
+                channelData[ch] = buffer.getWritePointer(bufferChannel);
             }
-
-            // Measure per-slot input levels
-            if (numBufferChannels >= 2)
+            else
             {
-                float peakL = buffer.getMagnitude(0, 0, numSamples);
-                float peakR = buffer.getMagnitude(1, 0, numSamples);
-                float currentL = slot.inputLevelL.load();
-                float currentR = slot.inputLevelR.load();
-                slot.inputLevelL.store(peakL > currentL ? peakL : currentL * 0.95f);
-                slot.inputLevelR.store(peakR > currentR ? peakR : currentR * 0.95f);
+                channelData[ch] = padBuffer.getWritePointer(ch);
+                juce::FloatVectorOperations::clear(channelData[ch], numSamples);
             }
+        }
+
+        if (numPluginChannels > 0)
+        {
+            juce::AudioBuffer<PluginSampleType> pluginBuffer(channelData, numPluginChannels, numSamples);
+            slot.vst3Plugin->processBlock(pluginBuffer, midiMessages);
+        }
 
-            // Process either VST3 or CLAP plugin
-            if (slot.isVST3())
+        const int tail = slot.tailSamples.load();
+        silence.processed(inputSilent, numSamples, tail == SilenceTracker::INFINITE_TAIL ? tail : tail + slotLatency);
+    }
+    else if (slot.isCLAP())
+    {
+        // CLAP processing - main channels in place, sidechain channels straight to the aux input port
+        if (slot.clapPlugin != nullptr && slot.clapPlugin->isActive() && numBufferChannels >= mainChannels)
+        {
+            // Write modulation events straight into the plugin's input queue,
+            // walking only the routes compiled for this slot (already in time order)
+            if (slotIndex < chain.routeTables.size())
             {
-                int pluginInputChannels = slot.vst3Plugin->getTotalNumInputChannels();
+                const auto& routes = chain.routeTables[slotIndex];
+                const size_t numRoutes = routes.size();
+                constexpr int MOD_BLOCK_SIZE = ModulationEngine::MOD_BLOCK_SIZE;
 
-                if (pluginInputChannels <= mainChannels)
+                // Stale cookies must not reach the plugin - fall back to param_id lookup
+                const bool cookiesValid = routes.cookieGeneration == slot.clapPlugin->getCookieGeneration();
+
+                for (int point = 0; point < numModPoints; ++point)
                 {
-                    // Plugin doesn't use sidechain - pass main channels only
-                    if (numBufferChannels >= mainChannels)
+                    for (size_t r = 0; r < numRoutes; ++r)
                     {
-                        float* channelData[2] = { buffer.getWritePointer(0), buffer.getWritePointer(1) };
-                        juce::AudioBuffer<float> mainBuffer(channelData, mainChannels, numSamples);
-                        slot.vst3Plugin->processBlock(mainBuffer, midiMessages);
+                        slot.clapPlugin->addModulationEvent(static_cast<uint32_t>(point * MOD_BLOCK_SIZE),
+                                                            routes.paramIds[r],
+                                                            cookiesValid ? routes.cookies[r] : nullptr,
+                                                            modulationEngine.getRow(routes.sourceRows[r])[point] * routes.scaledAmounts[r]);
                     }
                 }
-                else if (hasSidechainInput && numBufferChannels >= 4)
-                {
-                    // Plugin uses sidechain and we have sidechain input - pass full buffer
-                    slot.vst3Plugin->processBlock(buffer, midiMessages);
-                }
-                else
-                {
-                    // Plugin uses sidechain but wrapper doesn't have sidechain connected
-                    // Create a 4-channel buffer with main audio + silent sidechain
-                    juce::AudioBuffer<float> pluginBuffer(4, numSamples);
-
-                    // Copy main channels
-                    pluginBuffer.copyFrom(0, 0, buffer, 0, 0, numSamples);
-                    pluginBuffer.copyFrom(1, 0, buffer, 1, 0, numSamples);
+            }
 
-                    // Clear sidechain channels (silence)
-                    pluginBuffer.clear(2, 0, numSamples);
-                    pluginBuffer.clear(3, 0, numSamples);
+            // The returned status says how long the plugin wants to keep running on silence
+            switch (slot.clapPlugin->process(buffer, mainChannels, midiMessages, constantChannels))
+            {
+                case CLAP_PROCESS_SLEEP:
+                    silence.pluginIsQuiet(inputSilent);
+                    break;
 
-                    slot.vst3Plugin->processBlock(pluginBuffer, midiMessages);
+                case CLAP_PROCESS_CONTINUE_IF_NOT_QUIET:
+                    if (SilenceTracker::isSilent(buffer.getArrayOfReadPointers(), numMainChannels, numSamples))
+                        silence.pluginIsQuiet(inputSilent);
+                    break;
 
-                    // Copy processed main channels back
-                    buffer.copyFrom(0, 0, pluginBuffer, 0, 0, numSamples);
-                    buffer.copyFrom(1, 0, pluginBuffer, 1, 0, numSamples);
+                case CLAP_PROCESS_TAIL:
+                {
+                    const uint32_t tail = slot.clapPlugin->getTailSamples();
+                    silence.processed(inputSilent, numSamples,
+                                      tail > static_cast<uint32_t>(SilenceTracker::MAX_TAIL_SAMPLES)
+                                          ? SilenceTracker::INFINITE_TAIL : static_cast<int>(tail) + slotLatency);
+                    break;
                 }
+
+                default:  // CLAP_PROCESS_CONTINUE, CLAP_PROCESS_ERROR: keep it running
+                    break;
             }
-            else if (slot.isCLAP())
-            {
-                // CLAP processing - pass stereo buffer with modulation
-                if (slot.clapPlugin != nullptr && slot.clapPlugin->isActive() && numBufferChannels >= mainChannels)
-                {
-                    static int clapProcessCount = 0;
-                    if (clapProcessCount < 3)
-                    {
-                        std::cerr << "[RACK] CLAP process #" << clapProcessCount << std::endl << std::flush;
-                        clapProcessCount++;
-                    }
+        }
+    }
+}
 
-                    float* channelData[2] = { buffer.getWritePointer(0), buffer.getWritePointer(1) };
-                    juce::AudioBuffer<float> mainBuffer(channelData, mainChannels, numSamples);
+template <typename SampleType>
+void UhbikWrapperAudioProcessor::processParallelGroup(const ChainSnapshot& chain, const SlotGroup& group,
+                                                      juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages,
+                                                      bool useWorkers)
+{
+    const int numBufferChannels = buffer.getNumChannels();
+    const int mainChannels = scratch.getNumMainChannels();
+    const int numSamples = buffer.getNumSamples();
 
-                    // Get current slot index for modulation routing
-                    int currentSlotIndex = static_cast<int>(&slot - effectChain.data());
+    // Children are padded to the slowest one so their outputs line up when summed
+    int groupLatency = 0;
+    for (size_t i = group.first; i < group.first + group.count; ++i)
+        groupLatency = juce::jmax(groupLatency, chain.slots[i]->latencySamples.load());
 
-                    // Generate modulation events for this slot
-                    // Pre-allocate to avoid audio-thread allocation (max: routes * blocks)
-                    std::vector<CLAPPluginInstance::ModulationEvent> modEvents;
-                    modEvents.reserve(64);
+    // Each child copies the group input into its own branch buffer, so the jobs
+    // share nothing but read-only state. The branch always carries sidechain
+    // channels (silent if the host has none).
+    auto processBranch = [&](int job)
+    {
+        const size_t slotIndex = group.first + static_cast<size_t>(job);
+        auto& slot = *chain.slots[slotIndex];
+        if (!slot.hasPlugin() || !slot.ready.load())
+            return;
 
-                    // Try to lock modulation routes - skip modulation if locked
-                    const juce::SpinLock::ScopedTryLockType modLock(modulationLock);
-                    if (modLock.isLocked())
-                    {
-                        // Process modulation at 64-sample granularity for smooth modulation
-                        constexpr int MOD_BLOCK_SIZE = 64;
-                        for (int sampleOffset = 0; sampleOffset < numSamples; sampleOffset += MOD_BLOCK_SIZE)
-                        {
-                            // Tick all modulation sources for this block
-                            float lfoValues[NUM_LFOS];
-                            for (int lfo = 0; lfo < NUM_LFOS; ++lfo)
-                                lfoValues[lfo] = lfos[lfo].tick();
-
-                            float envValues[NUM_ENVELOPES];
-                            for (int env = 0; env < NUM_ENVELOPES; ++env)
-                                envValues[env] = envelopes[env].tick();
-
-                            float seqValues[NUM_STEP_SEQS];
-                            for (int seq = 0; seq < NUM_STEP_SEQS; ++seq)
-                                seqValues[seq] = stepSequencers[seq].process();
-
-                            // Generate modulation events for routes targeting this slot
-                            for (const auto& route : modulationRoutes)
-                            {
-                                if (route.enabled && route.target.slotIndex == currentSlotIndex)
-                                {
-                                    // Get modulation value based on source type
-                                    float modValue = 0.0f;
-                                    switch (route.sourceType)
-                                    {
-                                        case ModSourceType::LFO:
-                                            if (route.sourceIndex >= 0 && route.sourceIndex < NUM_LFOS)
-                                                modValue = lfoValues[route.sourceIndex];
-                                            break;
-                                        case ModSourceType::Envelope:
-                                            if (route.sourceIndex >= 0 && route.sourceIndex < NUM_ENVELOPES)
-                                                modValue = envValues[route.sourceIndex];
-                                            break;
-                                        case ModSourceType::StepSequencer:
-                                            if (route.sourceIndex >= 0 && route.sourceIndex < NUM_STEP_SEQS)
-                                                modValue = seqValues[route.sourceIndex];
-                                            break;
-                                        case ModSourceType::Macro:
-                                            if (route.sourceIndex >= 0 && route.sourceIndex < NUM_MACROS)
-                                            {
-                                                // Use cached pointer - no string allocation on audio thread
-                                                if (macroParams[route.sourceIndex] != nullptr)
-                                                    modValue = (macroParams[route.sourceIndex]->load() * 2.0f - 1.0f);
-                                            }
-                                            break;
-                                    }
-
-                                    // Calculate modulation amount in parameter value units
-                                    double paramRange = route.target.maxValue - route.target.minValue;
-                                    double modAmount = modValue * route.amount * paramRange;
-
-                                    CLAPPluginInstance::ModulationEvent event;
-                                    event.paramId = route.target.paramId;
-                                    event.amount = modAmount;
-                                    event.sampleOffset = static_cast<uint32_t>(sampleOffset);
-                                    modEvents.push_back(event);
-                                }
-                            }
-
-                            // Advance all modulation sources by remaining samples in this block
-                            int samplesInBlock = juce::jmin(MOD_BLOCK_SIZE - 1, numSamples - sampleOffset - 1);
-                            for (int s = 0; s < samplesInBlock; ++s)
-                            {
-                                for (int lfo = 0; lfo < NUM_LFOS; ++lfo)
-                                    lfos[lfo].tick();
-                                for (int env = 0; env < NUM_ENVELOPES; ++env)
-                                    envelopes[env].tick();
-                                for (int seq = 0; seq < NUM_STEP_SEQS; ++seq)
-                                    stepSequencers[seq].process();
-                            }
-                        }
-                    }
+        const auto startTicks = juce::Time::getHighResolutionTicks();
 
-                    // Process with modulation events
-                    if (modEvents.empty())
-                        slot.clapPlugin->process(mainBuffer, midiMessages);
-                    else
-                        slot.clapPlugin->processWithModulation(mainBuffer, midiMessages, modEvents);
-                }
-            }
+        auto& branchBuffer = slot.scratch.branchBuffer.get<SampleType>();
+        const int branchChannels = branchBuffer.getNumChannels();
+        for (int ch = 0; ch < branchChannels; ++ch)
+        {
+            if (ch < numBufferChannels)
+                branchBuffer.copyFrom(ch, 0, buffer, ch, 0, numSamples);
+            else
+                branchBuffer.clear(ch, 0, numSamples);
+        }
 
-            // Apply per-slot output gain
-            if (slotOutputGain != 1.0f)
-            {
-                for (int ch = 0; ch < mainChannels && ch < numBufferChannels; ++ch)
-                    buffer.applyGain(ch, 0, numSamples, slotOutputGain);
-            }
+        auto& branchMidi = slot.scratch.branchMidi;
+        branchMidi.clear();
+        branchMidi.addEvents(midiMessages, 0, numSamples, 0);
 
-            // Apply per-slot wet/dry mix
-            if (slotDry > 0.0f)
-            {
-                for (int ch = 0; ch < mainChannels && ch < numBufferChannels; ++ch)
-                {
-                    buffer.applyGain(ch, 0, numSamples, slotWet);
-                    buffer.addFrom(ch, 0, slotDryBuffer, ch, 0, numSamples, slotDry);
-                }
-            }
+        juce::AudioBuffer<SampleType> branch(branchBuffer.getArrayOfWritePointers(), branchChannels, numSamples);
+        const int slotLatency = slot.latencySamples.load();
+        processSlot(chain, slotIndex, branch, branchMidi, slotLatency);
+        slot.scratch.alignDelay.process(branch, branch, mainChannels, numSamples, groupLatency - slotLatency);
 
-            // Measure per-slot output levels
-            if (numBufferChannels >= 2)
-            {
-                float peakL = buffer.getMagnitude(0, 0, numSamples);
-                float peakR = buffer.getMagnitude(1, 0, numSamples);
-                float currentL = slot.outputLevelL.load();
-                float currentR = slot.outputLevelR.load();
-                slot.outputLevelL.store(peakL > currentL ? peakL : currentL * 0.95f);
-                slot.outputLevelR.store(peakR > currentR ? peakR : currentR * 0.95f);
-            }
-        }
+        slot.scratch.processTicks = juce::Time::getHighResolutionTicks() - startTicks;
+    };
+
+    // Inside a pipeline stage the pool is already busy running the stages
+    const auto groupStartTicks = juce::Time::getHighResolutionTicks();
+    if (useWorkers)
+    {
+        workerPool.run(static_cast<int>(group.count), processBranch);
+    }
+    else
+    {
+        for (int job = 0; job < static_cast<int>(group.count); ++job)
+            processBranch(job);
     }
+    const auto groupTicks = juce::Time::getHighResolutionTicks() - groupStartTicks;
 
-    // Apply wet/dry mix
-    if (dryMix > 0.0f)
+    // Sum the branches. A bypassed child passes its input through like a serial
+    // slot; children without a ready plugin drop out.
+    bool anyBranch = false;
+    int64_t jobTicks = 0;
+    for (size_t i = group.first; i < group.first + group.count; ++i)
     {
+        auto& slot = *chain.slots[i];
+        if (!slot.hasPlugin() || !slot.ready.load())
+            continue;
+
+        const auto& branchBuffer = slot.scratch.branchBuffer.get<SampleType>();
         for (int ch = 0; ch < mainChannels && ch < numBufferChannels; ++ch)
         {
-            buffer.applyGain(ch, 0, numSamples, wetMix);
-            buffer.addFrom(ch, 0, dryBuffer, ch, 0, numSamples, dryMix);
+            if (anyBranch)
+                buffer.addFrom(ch, 0, branchBuffer, ch, 0, numSamples);
+            else
+                buffer.copyFrom(ch, 0, branchBuffer, ch, 0, numSamples);
         }
+
+        anyBranch = true;
+        jobTicks += slot.scratch.processTicks;
     }
 
-    // === DUCKER PROCESSING ===
-    if (duckerEnabled.load() && hasSidechainInput)
+    // Work the pool took off the audio thread (for the serial CPU estimate)
+    if (useWorkers)
+        parallelSavedTicks += juce::jmax<int64_t>(0, jobTicks - groupTicks);
+}
+
+template <typename SampleType>
+void UhbikWrapperAudioProcessor::processPipelined(const ChainSnapshot& chain, juce::AudioBuffer<SampleType>& buffer,
+                                                  juce::MidiBuffer& midiMessages)
+{
+    const int numBufferChannels = buffer.getNumChannels();
+    const int mainChannels = scratch.getNumMainChannels();
+    const int numSamples = buffer.getNumSamples();
+    const int numStages = static_cast<int>(chain.stages.size());
+
+    // Audio left in the FIFOs from a different stage layout belongs to other slots
+    const bool sameLayout = activePipelineStages.size() == chain.stages.size()
+        && std::equal(chain.stages.begin(), chain.stages.end(), activePipelineStages.begin(),
+                      [](const PipelineStage& a, const PipelineStage& b)
+                      { return a.firstGroup == b.firstGroup && a.numGroups == b.numGroups; });
+    if (!sameLayout)
     {
-        // Get ducker parameters
-        float thresholdDb = duckerThresholdDb.load();
-        float amount = duckerAmount.load() / 100.0f;  // Convert to 0-1
-        float attackMs = duckerAttackMs.load();
-        float releaseMs = duckerReleaseMs.load();
-        float holdMs = duckerHoldMs.load();
+        for (int i = 0; i < numStages; ++i)
+            scratch.getPipelineStage(i).output.reset();
+        activePipelineStages.assign(chain.stages.begin(), chain.stages.end());  // Capacity reserved in prepareToPlay
+    }
 
-        // Calculate envelope coefficients
-        float attackCoef = std::exp(-1.0f / (static_cast<float>(currentSampleRate) * attackMs * 0.001f));
-        float releaseCoef = std::exp(-1.0f / (static_cast<float>(currentSampleRate) * releaseMs * 0.001f));
-        float holdSamples = static_cast<float>(currentSampleRate) * holdMs * 0.001f;
+    // Every stage works on its own buffer: stage 0 takes this block's input, the
+    // others take what the previous stage produced one block ago. Sidechain
+    // channels travel with the audio so they stay aligned at every stage.
+    auto processStage = [&](int stageIndex)
+    {
+        const auto startTicks = juce::Time::getHighResolutionTicks();
 
-        // Convert threshold to linear
-        float thresholdLin = juce::Decibels::decibelsToGain(thresholdDb);
+        auto& stage = scratch.getPipelineStage(stageIndex);
+        auto& stageStorage = stage.buffer.get<SampleType>();
+        const int stageChannels = stageStorage.getNumChannels();
+        juce::AudioBuffer<SampleType> stageBuffer(stageStorage.getArrayOfWritePointers(), stageChannels, numSamples);
 
-        // Process sample-by-sample for accurate envelope
-        for (int sample = 0; sample < numSamples; ++sample)
+        if (stageIndex == 0)
         {
-            // Get sidechain level (channels 2 and 3)
-            float scLeft = (numBufferChannels > 2) ? std::abs(buffer.getSample(2, sample)) : 0.0f;
-            float scRight = (numBufferChannels > 3) ? std::abs(buffer.getSample(3, sample)) : scLeft;
-            float scLevel = std::max(scLeft, scRight);
-
-            // Envelope follower with hold
-            float targetEnv = (scLevel > thresholdLin) ? 1.0f : 0.0f;
-
-            if (targetEnv > duckerEnvelope)
+            for (int ch = 0; ch < stageChannels; ++ch)
             {
-                // Attack - sidechain is above threshold
-                duckerEnvelope = attackCoef * duckerEnvelope + (1.0f - attackCoef) * targetEnv;
-                duckerHoldCounter = holdSamples;  // Reset hold counter
-            }
-            else if (duckerHoldCounter > 0.0f)
-            {
-                // Hold phase - maintain current envelope
-                duckerHoldCounter -= 1.0f;
+                if (ch < numBufferChannels)
+                    stageBuffer.copyFrom(ch, 0, buffer, ch, 0, numSamples);
+                else
+                    stageBuffer.clear(ch, 0, numSamples);
             }
-            else
+        }
+        else
+        {
+            scratch.getPipelineStage(stageIndex - 1).output.read(stageBuffer, numSamples);
+        }
+
+        // Host MIDI is only in time with the first stage
+        stage.midi.clear();
+        auto& stageMidi = stageIndex == 0 ? midiMessages : stage.midi;
+
+        const auto& pipelineStage = chain.stages[static_cast<size_t>(stageIndex)];
+        for (size_t g = pipelineStage.firstGroup; g < pipelineStage.firstGroup + pipelineStage.numGroups; ++g)
+        {
+            const auto& group = chain.groups[g];
+            if (group.count > 1)
             {
-                // Release - sidechain is below threshold and hold expired
-                duckerEnvelope = releaseCoef * duckerEnvelope + (1.0f - releaseCoef) * targetEnv;
+                processParallelGroup(chain, group, stageBuffer, stageMidi, false);
+                continue;
             }
 
-            // Calculate gain reduction (1.0 = no reduction, 0.0 = full reduction)
-            float gainReduction = 1.0f - (duckerEnvelope * amount);
-
-            // Apply gain reduction to main channels
-            buffer.setSample(0, sample, buffer.getSample(0, sample) * gainReduction);
-            if (mainChannels > 1)
-                buffer.setSample(1, sample, buffer.getSample(1, sample) * gainReduction);
+            auto& slot = *chain.slots[group.first];
+            if (slot.hasPlugin() && slot.ready.load())
+                processSlot(chain, group.first, stageBuffer, stageMidi, slot.latencySamples.load());
         }
 
-        // Store gain reduction for UI metering (convert to dB-friendly value)
-        duckerGainReduction.store(duckerEnvelope * amount);
-    }
-    else
-    {
-        // Ducker disabled or no sidechain - decay the meter
-        float currentGR = duckerGainReduction.load();
-        if (currentGR > 0.001f)
-            duckerGainReduction.store(currentGR * 0.95f);
-        else
-            duckerGainReduction.store(0.0f);
-    }
+        if (stageIndex < numStages - 1)
+            stage.output.write(stageBuffer, numSamples);
+
+        stage.processTicks = juce::Time::getHighResolutionTicks() - startTicks;
+    };
+
+    const auto pipelineStartTicks = juce::Time::getHighResolutionTicks();
+    workerPool.run(numStages, processStage);
+    const auto pipelineTicks = juce::Time::getHighResolutionTicks() - pipelineStartTicks;
 
-    // Apply output gain to main channels
+    // The last stage's output is the chain output
+    const auto& lastStage = scratch.getPipelineStage(numStages - 1).buffer.get<SampleType>();
     for (int ch = 0; ch < mainChannels && ch < numBufferChannels; ++ch)
-        buffer.applyGain(ch, 0, numSamples, outputGain);
+        buffer.copyFrom(ch, 0, lastStage, ch, 0, numSamples);
 
-    // Measure master output levels
-    if (numBufferChannels >= 2)
+    int64_t stageTicks = 0;
+    for (int i = 0; i < numStages; ++i)
     {
-        float peakL = buffer.getMagnitude(0, 0, numSamples);
-        float peakR = buffer.getMagnitude(1, 0, numSamples);
-        float currentL = masterOutputLevelL.load();
-        float currentR = masterOutputLevelR.load();
-        masterOutputLevelL.store(peakL > currentL ? peakL : currentL * 0.95f);
-        masterOutputLevelR.store(peakR > currentR ? peakR : currentR * 0.95f);
+        auto& stage = scratch.getPipelineStage(i);
+        stage.output.advance(numSamples);
+        stageTicks += stage.processTicks;
     }
+
+    parallelSavedTicks += juce::jmax<int64_t>(0, stageTicks - pipelineTicks);
 }
 
 bool UhbikWrapperAudioProcessor::hasEditor() const
@@ -1186,13 +2136,20 @@ void UhbikWrapperAudioProcessor::getStateInformation (juce::MemoryBlock& destDat
     if (debugLogging.load())
         std::cerr << "[RACK] getStateInformation called. Chain size: " << effectChain.size() << std::endl << std::flush;
 
+    const auto saveStartMs = juce::Time::getMillisecondCounterHiRes();
+
+    // Plugin states go into binary chunks; the tree only holds the settings
+    ChainStateFormat::Writer writer;
+
     juce::ValueTree state("EffectChainState");
-    state.setProperty("version", 4, nullptr);  // Version 4 adds ducker
+    state.setProperty("version", 5, nullptr);  // Version 5: binary chunks (see ChainStateFormat)
     state.setProperty("chainSize", static_cast<int>(effectChain.size()), nullptr);
 
     // Save UI state
     state.setProperty("debugLogging", debugLogging.load(), nullptr);
     state.setProperty("uiScale", uiScale.load(), nullptr);
+    state.setProperty("workerThreads", getNumWorkerThreads(), nullptr);
+    state.setProperty("pipelined", pipelinedChain, nullptr);
 
     // Save ducker state
     state.setProperty("duckerEnabled", duckerEnabled.load(), nullptr);
@@ -1201,6 +2158,8 @@ void UhbikWrapperAudioProcessor::getStateInformation (juce::MemoryBlock& destDat
     state.setProperty("duckerAttackMs", duckerAttackMs.load(), nullptr);
     state.setProperty("duckerReleaseMs", duckerReleaseMs.load(), nullptr);
     state.setProperty("duckerHoldMs", duckerHoldMs.load(), nullptr);
+    state.setProperty("duckerRms", duckerRmsDetector.load(), nullptr);
+    state.setProperty("duckerLookaheadMs", duckerLookaheadMs.load(), nullptr);
 
     // Save APVTS parameters
     auto apvtsState = apvts.copyState();
@@ -1208,10 +2167,11 @@ void UhbikWrapperAudioProcessor::getStateInformation (juce::MemoryBlock& destDat
 
     for (size_t i = 0; i < effectChain.size(); ++i)
     {
-        auto& slot = effectChain[i];
+        auto& slot = *effectChain[i];
         juce::ValueTree slotState("Slot");
         slotState.setProperty("index", static_cast<int>(i), nullptr);
-        slotState.setProperty("bypassed", slot.bypassed, nullptr);
+        slotState.setProperty("bypassed", slot.bypassed.load(), nullptr);
+        slotState.setProperty("parallel", slot.parallelWithPrevious, nullptr);
         slotState.setProperty("pluginName", slot.description.name, nullptr);
 
         // Per-slot mixing parameters
@@ -1222,7 +2182,8 @@ void UhbikWrapperAudioProcessor::getStateInformation (juce::MemoryBlock& destDat
         // Save format type
         slotState.setProperty("format", slot.description.format == UnifiedPluginDescription::Format::CLAP ? "CLAP" : "VST3", nullptr);
 
-        if (slot.isVST3())
+        // By format rather than instance, so slots still loading are saved too
+        if (slot.description.format == UnifiedPluginDescription::Format::VST3)
         {
             // VST3: Save PluginDescription XML
             auto descXml = slot.description.vst3Desc.createXml();
@@ -1237,12 +2198,12 @@ void UhbikWrapperAudioProcessor::getStateInformation (juce::MemoryBlock& destDat
             {
                 juce::MemoryBlock pluginState;
                 slot.vst3Plugin->getStateInformation(pluginState);
-                slotState.setProperty("pluginState", pluginState.toBase64Encoding(), nullptr);
+                writer.addChunk(ChainStateFormat::pluginChunk, static_cast<int>(i), pluginState.getData(), pluginState.getSize());
                 if (debugLogging.load())
                     std::cerr << "[RACK] Saved VST3 state size: " << pluginState.getSize() << std::endl << std::flush;
             }
         }
-        else if (slot.isCLAP())
+        else
         {
             // CLAP: Save CLAPPluginDescription fields
             slotState.setProperty("clapPluginId", slot.description.clapDesc.pluginId, nullptr);
@@ -1260,7 +2221,7 @@ void UhbikWrapperAudioProcessor::getStateInformation (juce::MemoryBlock& destDat
                 slot.clapPlugin->getState(clapState);
                 if (clapState.getSize() > 0)
                 {
-                    slotState.setProperty("pluginState", clapState.toBase64Encoding(), nullptr);
+                    writer.addChunk(ChainStateFormat::pluginChunk, static_cast<int>(i), clapState.getData(), clapState.getSize());
                     if (debugLogging.load())
                         std::cerr << "[RACK] Saved CLAP state size: " << clapState.getSize() << std::endl << std::flush;
                 }
@@ -1270,13 +2231,14 @@ void UhbikWrapperAudioProcessor::getStateInformation (juce::MemoryBlock& destDat
         state.addChild(slotState, -1, nullptr);
     }
 
-    auto xml = state.createXml();
-    if (xml != nullptr)
-    {
-        copyXmlToBinary(*xml, destData);
-        if (debugLogging.load())
-            std::cerr << "[RACK] State saved. Total size: " << destData.getSize() << std::endl << std::flush;
-    }
+    juce::MemoryOutputStream settings;
+    state.writeToStream(settings);
+    writer.addChunk(ChainStateFormat::settingsChunk, -1, settings.getData(), settings.getDataSize());
+    writer.writeTo(destData);
+
+    if (debugLogging.load())
+        std::cerr << "[RACK] State saved. Total size: " << destData.getSize() << " in "
+                  << juce::String(juce::Time::getMillisecondCounterHiRes() - saveStartMs, 1) << " ms" << std::endl << std::flush;
 }
 
 void UhbikWrapperAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
@@ -1291,15 +2253,37 @@ void UhbikWrapperAudioProcessor::setStateInformation (const void* data, int size
         return;
     }
 
-    auto xml = getXmlFromBinary(data, sizeInBytes);
-    if (xml == nullptr)
+    // Version 5 binary chunks, or the version 4 (and earlier) XML with base64 plugin states
+    ChainStateFormat::Reader binaryState;
+    const bool isBinary = ChainStateFormat::isBinaryState(data, static_cast<size_t>(sizeInBytes));
+    juce::ValueTree state;
+
+    if (isBinary)
     {
-        if (debugLogging.load())
-            std::cerr << "[RACK] Failed to parse XML from binary" << std::endl << std::flush;
-        return;
+        juce::MemoryBlock settings;
+        if (!binaryState.open(data, static_cast<size_t>(sizeInBytes))
+            || !binaryState.readChunk(ChainStateFormat::settingsChunk, -1, settings))
+        {
+            if (debugLogging.load())
+                std::cerr << "[RACK] Failed to read binary state" << std::endl << std::flush;
+            return;
+        }
+
+        state = juce::ValueTree::readFromData(settings.getData(), settings.getSize());
+    }
+    else
+    {
+        auto xml = getXmlFromBinary(data, sizeInBytes);
+        if (xml == nullptr)
+        {
+            if (debugLogging.load())
+                std::cerr << "[RACK] Failed to parse XML from binary" << std::endl << std::flush;
+            return;
+        }
+
+        state = juce::ValueTree::fromXml(*xml);
     }
 
-    juce::ValueTree state = juce::ValueTree::fromXml(*xml);
     if (!state.isValid() || state.getType().toString() != "EffectChainState")
     {
         if (debugLogging.load())
@@ -1310,6 +2294,8 @@ void UhbikWrapperAudioProcessor::setStateInformation (const void* data, int size
     // Restore UI state
     debugLogging.store(static_cast<bool>(state.getProperty("debugLogging", false)));
     uiScale.store(static_cast<float>(state.getProperty("uiScale", 1.0f)));
+    pipelinedChain = static_cast<bool>(state.getProperty("pipelined", false));
+    setNumWorkerThreads(static_cast<int>(state.getProperty("workerThreads", DEFAULT_WORKER_THREADS)));
 
     // Restore ducker state
     duckerEnabled.store(static_cast<bool>(state.getProperty("duckerEnabled", false)));
@@ -1318,6 +2304,9 @@ void UhbikWrapperAudioProcessor::setStateInformation (const void* data, int size
     duckerAttackMs.store(static_cast<float>(state.getProperty("duckerAttackMs", 5.0f)));
     duckerReleaseMs.store(static_cast<float>(state.getProperty("duckerReleaseMs", 200.0f)));
     duckerHoldMs.store(static_cast<float>(state.getProperty("duckerHoldMs", 0.0f)));
+    duckerRmsDetector.store(static_cast<bool>(state.getProperty("duckerRms", false)));
+    duckerLookaheadMs.store(juce::jlimit(0.0f, Ducker::MAX_LOOKAHEAD_MS,
+                                         static_cast<float>(state.getProperty("duckerLookaheadMs", 0.0f))));
 
     // Restore APVTS parameters
     auto apvtsChild = state.getChildWithName("Parameters");
@@ -1332,162 +2321,228 @@ void UhbikWrapperAudioProcessor::setStateInformation (const void* data, int size
     if (debugLogging.load())
         std::cerr << "[RACK] Restoring " << savedChainSize << " plugins" << std::endl << std::flush;
 
-    std::vector<EffectSlot> newChain;
+    const auto restoreStartMs = juce::Time::getMillisecondCounterHiRes();
 
+    // Decode every slot before touching any plugin
+    std::vector<SavedSlot> savedSlots;
     for (int i = 0; i < state.getNumChildren(); ++i)
     {
         auto slotState = state.getChild(i);
         if (slotState.getType().toString() != "Slot")
             continue;
 
-        juce::String pluginName = slotState.getProperty("pluginName", "Unknown");
-        juce::String format = slotState.getProperty("format", "VST3").toString();
+        SavedSlot saved;
+        if (!decodeSavedSlot(slotState, saved))
+            continue;
+
+        if (isBinary)
+            binaryState.readChunk(ChainStateFormat::pluginChunk, slotState.getProperty("index", -1), saved.pluginState);
 
-        if (debugLogging.load())
-            std::cerr << "[RACK] Restoring " << format << " slot " << i << ": " << pluginName << std::endl << std::flush;
+        savedSlots.push_back(std::move(saved));
+    }
 
-        double sr = getSampleRate() > 0 ? getSampleRate() : 44100.0;
-        int bs = getBlockSize() > 0 ? getBlockSize() : 512;
+    // Keep loaded plugins the new chain also uses (in order, so repeated
+    // plugins pair up front to back). Loading placeholders never match. A slot
+    // saved without plugin state is loaded fresh: a reused plugin would keep
+    // its live state instead of coming back at its defaults.
+    std::vector<std::shared_ptr<EffectSlot>> reusedSlots(savedSlots.size());
+    std::vector<bool> claimed(effectChain.size(), false);
+    for (size_t i = 0; i < savedSlots.size(); ++i)
+    {
+        if (savedSlots[i].pluginState.getSize() == 0)
+            continue;
 
-        if (format == "CLAP")
+        for (size_t j = 0; j < effectChain.size(); ++j)
         {
-            // Restore CLAP plugin
-            std::cerr << "[RACK] Restoring CLAP plugin..." << std::endl << std::flush;
+            const auto& existing = *effectChain[j];
+            if (!claimed[j] && existing.hasPlugin()
+                && existing.description.format == savedSlots[i].description.format
+                && existing.description.pluginId == savedSlots[i].description.pluginId)
+            {
+                claimed[j] = true;
+                reusedSlots[i] = effectChain[j];
+                break;
+            }
+        }
+    }
+
+    // Instantiate the rest in chain order. Both formats create, activate and
+    // restore plugins on the message thread, so this can't be spread over a
+    // pool. The audio thread keeps running the previous chain until the swap below.
+    double sr = getSampleRate() > 0 ? getSampleRate() : 44100.0;
+    int bs = getBlockSize() > 0 ? getBlockSize() : 512;
 
-            CLAPPluginDescription clapDesc;
-            clapDesc.pluginId = slotState.getProperty("clapPluginId", "").toString();
-            clapDesc.pluginPath = slotState.getProperty("clapPluginPath", "").toString();
-            clapDesc.vendor = slotState.getProperty("clapVendor", "").toString();
-            clapDesc.name = slotState.getProperty("clapName", "").toString();
-            clapDesc.version = slotState.getProperty("clapVersion", "").toString();
+    std::vector<std::shared_ptr<EffectSlot>> newChain;
+    for (size_t i = 0; i < savedSlots.size(); ++i)
+    {
+        const auto& saved = savedSlots[i];
 
-            std::cerr << "[RACK] CLAP desc: " << clapDesc.name << " path=" << clapDesc.pluginPath << std::endl << std::flush;
+        if (reusedSlots[i] != nullptr)
+        {
+            const auto applyStartMs = juce::Time::getMillisecondCounterHiRes();
+            applySavedSlot(*reusedSlots[i], saved);
+            if (debugLogging.load())
+                std::cerr << "[RACK] Restore slot " << i << " (" << saved.description.getFormatName() << " " << saved.description.name
+                          << "): reused, set state " << juce::String(juce::Time::getMillisecondCounterHiRes() - applyStartMs, 1)
+                          << " ms" << std::endl << std::flush;
+            newChain.push_back(reusedSlots[i]);
+            continue;
+        }
 
-            auto clapPlugin = std::make_unique<CLAPPluginInstance>(clapDesc);
-            std::cerr << "[RACK] CLAP instance created, loading..." << std::endl << std::flush;
+        const auto instantiateStartMs = juce::Time::getMillisecondCounterHiRes();
+        auto slot = instantiateSavedSlot(saved, sr, bs);
 
-            bool loaded = clapPlugin->load();
-            std::cerr << "[RACK] CLAP load result: " << (loaded ? "OK" : "FAILED") << std::endl << std::flush;
+        if (debugLogging.load())
+            std::cerr << "[RACK] Restore slot " << i << " (" << saved.description.getFormatName() << " " << saved.description.name << "): "
+                      << (slot != nullptr ? "OK" : "FAILED") << ", instantiate "
+                      << juce::String(juce::Time::getMillisecondCounterHiRes() - instantiateStartMs, 1) << " ms" << std::endl << std::flush;
 
-            if (loaded && clapPlugin->activate(sr, 1, static_cast<uint32_t>(bs)))
-            {
-                // Restore CLAP state
-                juce::String pluginStateBase64 = slotState.getProperty("pluginState").toString();
-                if (pluginStateBase64.isNotEmpty())
-                {
-                    juce::MemoryBlock pluginStateData;
-                    pluginStateData.fromBase64Encoding(pluginStateBase64);
-                    clapPlugin->setState(pluginStateData.getData(), pluginStateData.getSize());
-                    if (debugLogging.load())
-                        std::cerr << "[RACK] Restored CLAP state: " << pluginStateData.getSize() << " bytes" << std::endl << std::flush;
-                }
+        if (slot != nullptr)
+            newChain.push_back(std::move(slot));
+    }
 
-                EffectSlot slot;
-                slot.clapPlugin = std::move(clapPlugin);
-                slot.description.format = UnifiedPluginDescription::Format::CLAP;
-                slot.description.name = clapDesc.name;
-                slot.description.pluginId = clapDesc.pluginId;
-                slot.description.pluginPath = clapDesc.pluginPath;
-                slot.description.vendor = clapDesc.vendor;
-                slot.description.clapDesc = clapDesc;
-                slot.bypassed = static_cast<bool>(slotState.getProperty("bypassed", false));
-                slot.ready.store(true);
-
-                slot.inputGainDb.store(static_cast<float>(slotState.getProperty("inputGainDb", 0.0f)));
-                slot.outputGainDb.store(static_cast<float>(slotState.getProperty("outputGainDb", 0.0f)));
-                slot.mixPercent.store(static_cast<float>(slotState.getProperty("mixPercent", 100.0f)));
-
-                newChain.push_back(std::move(slot));
-                if (debugLogging.load())
-                    std::cerr << "[RACK] CLAP plugin restored successfully" << std::endl << std::flush;
-            }
-            else
-            {
-                if (debugLogging.load())
-                    std::cerr << "[RACK] Failed to load/activate CLAP plugin" << std::endl << std::flush;
-            }
-        }
-        else
+    // Unmatched old plugins are destroyed once the audio thread has let go of
+    // them. Modulation routes aren't part of the saved state: drop them with
+    // the old chain rather than let them land on whatever now sits at their
+    // index (reused plugins move), in the same publish as the new chain.
+    effectChain = std::move(newChain);
+    modulationRoutes.clear();
+    publishChain();
+
+    if (debugLogging.load())
+        std::cerr << "[RACK] State restored. Chain size: " << effectChain.size() << " in "
+                  << juce::String(juce::Time::getMillisecondCounterHiRes() - restoreStartMs, 1) << " ms" << std::endl << std::flush;
+    sendChangeMessage();
+}
+
+bool UhbikWrapperAudioProcessor::decodeSavedSlot(const juce::ValueTree& slotState, SavedSlot& saved) const
+{
+    juce::String pluginName = slotState.getProperty("pluginName", "Unknown");
+    juce::String format = slotState.getProperty("format", "VST3").toString();
+
+    if (debugLogging.load())
+        std::cerr << "[RACK] Decoding " << format << " slot: " << pluginName << std::endl << std::flush;
+
+    if (format == "CLAP")
+    {
+        CLAPPluginDescription clapDesc;
+        clapDesc.pluginId = slotState.getProperty("clapPluginId", "").toString();
+        clapDesc.pluginPath = slotState.getProperty("clapPluginPath", "").toString();
+        clapDesc.vendor = slotState.getProperty("clapVendor", "").toString();
+        clapDesc.name = slotState.getProperty("clapName", "").toString();
+        clapDesc.version = slotState.getProperty("clapVersion", "").toString();
+        saved.description = unifiedDescriptionFor(clapDesc);
+    }
+    else
+    {
+        juce::String descXmlStr = slotState.getProperty("description").toString();
+        auto descElement = juce::XmlDocument::parse(descXmlStr);
+        if (descElement == nullptr)
         {
-            // Restore VST3 plugin
-            juce::String descXmlStr = slotState.getProperty("description").toString();
-            auto descElement = juce::XmlDocument::parse(descXmlStr);
-            if (descElement == nullptr)
-            {
-                if (debugLogging.load())
-                    std::cerr << "[RACK] Failed to parse VST3 plugin description XML" << std::endl << std::flush;
-                continue;
-            }
+            if (debugLogging.load())
+                std::cerr << "[RACK] Failed to parse VST3 plugin description XML" << std::endl << std::flush;
+            return false;
+        }
 
-            juce::PluginDescription desc;
-            desc.loadFromXml(*descElement);
+        juce::PluginDescription desc;
+        desc.loadFromXml(*descElement);
+        saved.description = unifiedDescriptionFor(desc);
+    }
 
-            juce::String errorMsg;
-            auto plugin = pluginFormatManager.createPluginInstance(desc, sr, bs, errorMsg);
+    // Version 4 and earlier; newer states keep it in a binary chunk
+    juce::String pluginStateBase64 = slotState.getProperty("pluginState").toString();
+    if (pluginStateBase64.isNotEmpty())
+        saved.pluginState.fromBase64Encoding(pluginStateBase64);
 
-            if (plugin != nullptr)
-            {
-                // Always enable sidechain on hosted plugins that support it
-                int numInputBuses = plugin->getBusCount(true);
-                if (numInputBuses > 1)
-                {
-                    auto* pluginSidechain = plugin->getBus(true, 1);
-                    if (pluginSidechain != nullptr)
-                    {
-                        if (debugLogging.load())
-                            std::cerr << "[RACK] Enabling sidechain bus during restore" << std::endl << std::flush;
-                        pluginSidechain->enable(true);
-                    }
-                }
+    saved.bypassed = static_cast<bool>(slotState.getProperty("bypassed", false));
+    saved.parallelWithPrevious = static_cast<bool>(slotState.getProperty("parallel", false));
+    saved.inputGainDb = static_cast<float>(slotState.getProperty("inputGainDb", 0.0f));
+    saved.outputGainDb = static_cast<float>(slotState.getProperty("outputGainDb", 0.0f));
+    saved.mixPercent = static_cast<float>(slotState.getProperty("mixPercent", 100.0f));
+    return true;
+}
 
-                plugin->prepareToPlay(sr, bs);
+std::shared_ptr<EffectSlot> UhbikWrapperAudioProcessor::instantiateSavedSlot(const SavedSlot& saved, double sr, int bs)
+{
+    auto slot = std::make_shared<EffectSlot>();
 
-                juce::String pluginStateBase64 = slotState.getProperty("pluginState").toString();
-                if (pluginStateBase64.isNotEmpty())
-                {
-                    juce::MemoryBlock pluginStateData;
-                    pluginStateData.fromBase64Encoding(pluginStateBase64);
-                    plugin->setStateInformation(pluginStateData.getData(), static_cast<int>(pluginStateData.getSize()));
-                    if (debugLogging.load())
-                        std::cerr << "[RACK] Restored VST3 state: " << pluginStateData.getSize() << " bytes" << std::endl << std::flush;
-                }
+    if (saved.description.format == UnifiedPluginDescription::Format::CLAP)
+    {
+        const auto& clapDesc = saved.description.clapDesc;
+        std::cerr << "[RACK] CLAP desc: " << clapDesc.name << " path=" << clapDesc.pluginPath << std::endl << std::flush;
 
-                EffectSlot slot;
-                slot.vst3Plugin = std::move(plugin);
-                slot.description.format = UnifiedPluginDescription::Format::VST3;
-                slot.description.name = desc.name;
-                slot.description.pluginId = desc.uniqueId != 0 ? juce::String(desc.uniqueId) : desc.fileOrIdentifier;
-                slot.description.pluginPath = desc.fileOrIdentifier;
-                slot.description.vendor = desc.manufacturerName;
-                slot.description.isInstrument = desc.isInstrument;
-                slot.description.vst3Desc = desc;
-                slot.bypassed = static_cast<bool>(slotState.getProperty("bypassed", false));
-                slot.ready.store(true);
-
-                slot.inputGainDb.store(static_cast<float>(slotState.getProperty("inputGainDb", 0.0f)));
-                slot.outputGainDb.store(static_cast<float>(slotState.getProperty("outputGainDb", 0.0f)));
-                slot.mixPercent.store(static_cast<float>(slotState.getProperty("mixPercent", 100.0f)));
-
-                newChain.push_back(std::move(slot));
-                if (debugLogging.load())
-                    std::cerr << "[RACK] VST3 plugin restored successfully" << std::endl << std::flush;
-            }
-            else
+        auto clapPlugin = std::make_unique<CLAPPluginInstance>(clapDesc);
+
+        bool loaded = clapPlugin->load();
+        std::cerr << "[RACK] CLAP load result: " << (loaded ? "OK" : "FAILED") << std::endl << std::flush;
+
+        if (!loaded || !activateCLAP(*clapPlugin, sr, bs))
+        {
+            if (debugLogging.load())
+                std::cerr << "[RACK] Failed to load/activate CLAP plugin" << std::endl << std::flush;
+            return nullptr;
+        }
+
+        slot->clapPlugin = std::move(clapPlugin);
+        negotiatePlugin(*slot);
+    }
+    else
+    {
+        juce::String errorMsg;
+        auto plugin = pluginFormatManager.createPluginInstance(saved.description.vst3Desc, sr, bs, errorMsg);
+
+        if (plugin == nullptr)
+        {
+            if (debugLogging.load())
+                std::cerr << "[RACK] Failed to create VST3 plugin: " << errorMsg << std::endl << std::flush;
+            return nullptr;
+        }
+
+        // Always enable sidechain on hosted plugins that support it
+        int numInputBuses = plugin->getBusCount(true);
+        if (numInputBuses > 1)
+        {
+            auto* pluginSidechain = plugin->getBus(true, 1);
+            if (pluginSidechain != nullptr)
             {
                 if (debugLogging.load())
-                    std::cerr << "[RACK] Failed to create VST3 plugin: " << errorMsg << std::endl << std::flush;
+                    std::cerr << "[RACK] Enabling sidechain bus during restore" << std::endl << std::flush;
+                pluginSidechain->enable(true);
             }
         }
+
+        slot->vst3Plugin = std::move(plugin);
+        negotiatePlugin(*slot);
+        slot->vst3Plugin->prepareToPlay(sr, bs);
     }
 
+    scratch.prepareSlot(slot->scratch, slot->processesDouble, padChannelsFor(*slot));
+    slot->description = saved.description;
+    applySavedSlot(*slot, saved);
+    slot->ready.store(true);
+    return slot;
+}
+
+void UhbikWrapperAudioProcessor::applySavedSlot(EffectSlot& slot, const SavedSlot& saved)
+{
+    // Plugins accept new state while processing, so a reused slot stays live
+    if (saved.pluginState.getSize() > 0)
     {
-        const juce::SpinLock::ScopedLockType lock(chainLock);
-        effectChain = std::move(newChain);
+        if (slot.clapPlugin != nullptr)
+            slot.clapPlugin->setState(saved.pluginState.getData(), saved.pluginState.getSize());
+        else if (slot.vst3Plugin != nullptr)
+            slot.vst3Plugin->setStateInformation(saved.pluginState.getData(), static_cast<int>(saved.pluginState.getSize()));
+
+        if (debugLogging.load())
+            std::cerr << "[RACK] Restored " << saved.description.getFormatName() << " state: "
+                      << saved.pluginState.getSize() << " bytes" << std::endl << std::flush;
     }
 
-    if (debugLogging.load())
-        std::cerr << "[RACK] State restored. Chain size: " << effectChain.size() << std::endl << std::flush;
-    sendChangeMessage();
+    slot.bypassed.store(saved.bypassed);
+    slot.parallelWithPrevious = saved.parallelWithPrevious;  // Takes effect with the next publishChain()
+    slot.inputGainDb.store(saved.inputGainDb);
+    slot.outputGainDb.store(saved.outputGainDb);
+    slot.mixPercent.store(saved.mixPercent);
 }
 
 juce::File UhbikWrapperAudioProcessor::getPresetsFolder()
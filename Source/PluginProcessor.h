@@ -3,9 +3,15 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_audio_utils/juce_audio_utils.h>
 #include "CLAPPluginHost.h"
+#include "PluginScanCache.h"
+#include "ScanWorkerPool.h"
 #include "LFO.h"
 #include "Envelope.h"
+#include "Ducker.h"
 #include "StepSequencer.h"
+#include "RealtimeScratch.h"
+#include "ModulationEngine.h"
+#include "AudioWorkerPool.h"
 
 // Unified plugin description that works for both VST3 and CLAP
 struct UnifiedPluginDescription
@@ -34,8 +40,12 @@ struct EffectSlot
     std::unique_ptr<CLAPPluginInstance> clapPlugin;
 
     UnifiedPluginDescription description;
-    bool bypassed = false;
+    std::atomic<bool> bypassed{false};  // Message thread writes, audio thread reads
+    bool parallelWithPrevious = false;  // Runs alongside the previous slot (message thread; compiled into the snapshot)
+    bool loading = false;  // Placeholder shown while the plugin loads; replaced by the finished slot (message thread)
     std::atomic<bool> ready{false};  // Set true after prepareToPlay completes
+    bool processesDouble = false;    // Plugin runs in double precision (negotiated on the message thread before it's prepared)
+    int pluginMainChannels = 2;      // Main bus channels the plugin processes (negotiated); any others pass through
 
     // Per-effect mixing controls
     std::atomic<float> inputGainDb{0.0f};   // -24 to +24 dB
@@ -48,6 +58,16 @@ struct EffectSlot
     std::atomic<float> outputLevelL{0.0f};
     std::atomic<float> outputLevelR{0.0f};
 
+    // Reported plugin latency, compensated on the dry paths (message thread writes)
+    std::atomic<int> latencySamples{0};
+    // VST3 tail in samples (held to SilenceTracker::MIN_VST3_TAIL_SECONDS),
+    // INFINITE_TAIL if endless (message thread writes). CLAP tails come from the
+    // plugin's tail extension.
+    std::atomic<int> tailSamples{0};
+
+    // Audio-thread scratch memory (sized on the message thread)
+    SlotScratch scratch;
+
     EffectSlot() = default;
     ~EffectSlot() = default;
 
@@ -61,8 +81,12 @@ struct EffectSlot
         : vst3Plugin(std::move(other.vst3Plugin))
         , clapPlugin(std::move(other.clapPlugin))
         , description(std::move(other.description))
-        , bypassed(other.bypassed)
+        , bypassed(other.bypassed.load())
+        , parallelWithPrevious(other.parallelWithPrevious)
+        , loading(other.loading)
         , ready(other.ready.load())
+        , processesDouble(other.processesDouble)
+        , pluginMainChannels(other.pluginMainChannels)
         , inputGainDb(other.inputGainDb.load())
         , outputGainDb(other.outputGainDb.load())
         , mixPercent(other.mixPercent.load())
@@ -70,6 +94,9 @@ struct EffectSlot
         , inputLevelR(other.inputLevelR.load())
         , outputLevelL(other.outputLevelL.load())
         , outputLevelR(other.outputLevelR.load())
+        , latencySamples(other.latencySamples.load())
+        , tailSamples(other.tailSamples.load())
+        , scratch(std::move(other.scratch))
     {}
 
     // Custom move assignment
@@ -80,8 +107,12 @@ struct EffectSlot
             vst3Plugin = std::move(other.vst3Plugin);
             clapPlugin = std::move(other.clapPlugin);
             description = std::move(other.description);
-            bypassed = other.bypassed;
+            bypassed.store(other.bypassed.load());
+            parallelWithPrevious = other.parallelWithPrevious;
+            loading = other.loading;
             ready.store(other.ready.load());
+            processesDouble = other.processesDouble;
+            pluginMainChannels = other.pluginMainChannels;
             inputGainDb.store(other.inputGainDb.load());
             outputGainDb.store(other.outputGainDb.load());
             mixPercent.store(other.mixPercent.load());
@@ -89,6 +120,9 @@ struct EffectSlot
             inputLevelR.store(other.inputLevelR.load());
             outputLevelL.store(other.outputLevelL.load());
             outputLevelR.store(other.outputLevelR.load());
+            latencySamples.store(other.latencySamples.load());
+            tailSamples.store(other.tailSamples.load());
+            scratch = std::move(other.scratch);
         }
         return *this;
     }
@@ -99,7 +133,8 @@ struct EffectSlot
 };
 
 class UhbikWrapperAudioProcessor  : public juce::AudioProcessor,
-                                    public juce::ChangeBroadcaster
+                                    public juce::ChangeBroadcaster,
+                                    private juce::Timer
 {
 public:
     // Parameter constants
@@ -119,8 +154,10 @@ public:
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
    #endif
 
+    // The chain runs in the host's precision; see negotiatePlugin()
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-    using juce::AudioProcessor::processBlock;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -146,14 +183,21 @@ public:
     juce::KnownPluginList knownPluginList;
     CLAPPluginScanner clapScanner;
 
+    // Scan results shared by all instances (and processes) - see PluginScanCache
+    juce::SharedResourcePointer<PluginScanCache> scanCache;
+
+    // Child processes that load new or changed plugins for the scan
+    ScanWorkerPool scanWorkers;
+
     // Unified list of all available plugins (VST3 + CLAP)
     std::vector<UnifiedPluginDescription> availablePlugins;
 
-    // Effect chain - use SpinLock for audio-safe synchronization
-    std::vector<EffectSlot> effectChain;
-    juce::SpinLock chainLock;
+    // Effect chain - message thread only. Every edit is followed by publishChain(),
+    // which hands the audio thread an immutable copy of this list.
+    std::vector<std::shared_ptr<EffectSlot>> effectChain;
 
-    // Chain management methods
+    // Chain management methods. addPlugin() returns straight away: a loading
+    // placeholder is appended and replaced once the plugin is ready.
     void scanForPlugins();
     void addPlugin(const juce::PluginDescription& desc);  // VST3
     void addPlugin(const CLAPPluginDescription& desc);    // CLAP
@@ -162,6 +206,7 @@ public:
     void movePlugin(int fromIndex, int toIndex);
     void clearChain();
     void setPluginBypassed(int index, bool bypassed);
+    void setSlotParallel(int index, bool parallelWithPrevious);
     void setSlotInputGain(int index, float gainDb);
     void setSlotOutputGain(int index, float gainDb);
     void setSlotMix(int index, float mixPercent);
@@ -179,11 +224,28 @@ public:
     std::atomic<bool> debugLogging{true};  // On by default for debugging
     std::atomic<float> uiScale{1.0f};
 
+    // Worker threads for parallel branches (saved with plugin state)
+    static constexpr int DEFAULT_WORKER_THREADS = 2;
+    void setNumWorkerThreads(int numThreads);
+    int getNumWorkerThreads() const { return workerPool.getNumWorkers(); }
+
+    // Pipelined chain: split the chain into stages that run concurrently, one
+    // block apart, for (stages - 1) blocks of added latency (saved with plugin state)
+    void setPipelinedChain(bool shouldPipeline);
+    bool isPipelinedChain() const { return pipelinedChain; }
+
+    // DSP load as a fraction of the block duration (updated by audio thread, read by UI).
+    // serialCpuLoad estimates the load if every slot had run on the audio thread.
+    std::atomic<float> cpuLoad{0.0f};
+    std::atomic<float> serialCpuLoad{0.0f};
+
     // Master level metering (updated by audio thread, read by UI)
     std::atomic<float> masterInputLevelL{0.0f};
     std::atomic<float> masterInputLevelR{0.0f};
     std::atomic<float> masterOutputLevelL{0.0f};
     std::atomic<float> masterOutputLevelR{0.0f};
+    std::atomic<float> masterInputRms{0.0f};   // Block RMS, averaged over L/R
+    std::atomic<float> masterOutputRms{0.0f};
 
     // Ducker parameters (exposed to UI, stored in state)
     std::atomic<bool> duckerEnabled{false};
@@ -192,6 +254,8 @@ public:
     std::atomic<float> duckerAttackMs{5.0f};         // 0.1 to 100 ms
     std::atomic<float> duckerReleaseMs{200.0f};      // 10 to 2000 ms
     std::atomic<float> duckerHoldMs{0.0f};           // 0 to 500 ms
+    std::atomic<bool> duckerRmsDetector{false};      // RMS instead of peak sidechain detection
+    std::atomic<float> duckerLookaheadMs{0.0f};      // 0 to 20 ms (delays the output, reported as latency)
 
     // Ducker metering (for UI gain reduction display)
     std::atomic<float> duckerGainReduction{0.0f};    // 0.0 to 1.0 (amount of reduction)
@@ -205,9 +269,9 @@ public:
     Envelope envelopes[NUM_ENVELOPES];
     StepSequencer stepSequencers[NUM_STEP_SEQS];
 
-    // Modulation routing
+    // Modulation routing - message thread only. The audio thread reads the
+    // per-slot tables compiled from this by publishChain().
     std::vector<ModulationRoute> modulationRoutes;
-    juce::SpinLock modulationLock;
 
     // Modulation management methods
     void addModulationRoute(ModSourceType sourceType, int sourceIndex, int slotIndex, clap_id paramId, float amount);
@@ -219,6 +283,14 @@ public:
     // Get modulatable parameters from a slot
     std::vector<CLAPParameterInfo> getModulatableParametersForSlot(int slotIndex) const;
 
+    // Last value a slot's CLAP plugin reported for paramId from its own GUI.
+    // False if it hasn't reported one. Message thread.
+    bool getReportedCLAPParameterValue(int slotIndex, clap_id paramId, double& value) const;
+
+    // Changes whenever any CLAP plugin reports new parameter values, so the UI
+    // knows to redraw them. Message thread.
+    uint32_t getCLAPParamValueGeneration() const { return clapParamValueGeneration; }
+
     // LFO control
     void setLFOFrequency(int lfoIndex, float hz);
     void setLFOWaveform(int lfoIndex, LFOWaveform waveform);
@@ -247,13 +319,198 @@ public:
     float getModulationSourceValue(ModSourceType type, int index) const;
 
 private:
-    // Ducker envelope state (audio thread only)
-    float duckerEnvelope = 0.0f;
-    float duckerHoldCounter = 0.0f;
+    // Rebuild the CLAP part of availablePlugins from clapScanner
+    void addScannedCLAPPlugins();
+
+    // Async plugin loading (message thread). The placeholder is an empty,
+    // never-ready slot the audio thread skips; finishLoadingSlot() swaps the
+    // loaded slot in for it (or removes it if loaded is null) and publishes.
+    // If the placeholder has left the chain in the meantime the result is dropped.
+    std::shared_ptr<EffectSlot> addLoadingSlot(const UnifiedPluginDescription& description);
+    void finishVST3Load(const std::shared_ptr<EffectSlot>& placeholder,
+                        std::unique_ptr<juce::AudioPluginInstance> plugin, const juce::String& errorMsg);
+    void finishLoadingSlot(const std::shared_ptr<EffectSlot>& placeholder, std::shared_ptr<EffectSlot> loaded);
+
+    // Session restore. All saved slots are decoded first and matched against
+    // the current chain by format + pluginId; matched instances are kept and
+    // only get the saved state. The rest are created on the message thread
+    // (both formats require it) in chain order.
+    struct SavedSlot
+    {
+        UnifiedPluginDescription description;
+        juce::MemoryBlock pluginState;
+        bool bypassed = false;
+        bool parallelWithPrevious = false;
+        float inputGainDb = 0.0f;
+        float outputGainDb = 0.0f;
+        float mixPercent = 100.0f;
+    };
+
+    bool decodeSavedSlot(const juce::ValueTree& slotState, SavedSlot& saved) const;
+    // Message thread, before the slot's plugin is prepared (after activate()
+    // for CLAP). Gives a VST3 plugin the wrapper's main bus layout if it takes
+    // it, and records how many main channels the plugin covers. Runs the
+    // plugin in double if the chain does and the plugin supports it;
+    // otherwise a double chain converts at this slot only.
+    void negotiatePlugin(EffectSlot& slot);
+
+    // Activate a CLAP plugin, asking for a port configuration that matches the
+    // wrapper's main bus
+    bool activateCLAP(CLAPPluginInstance& plugin, double sampleRate, int blockSize);
+
+    std::shared_ptr<EffectSlot> instantiateSavedSlot(const SavedSlot& saved, double sampleRate, int blockSize);  // nullptr on failure
+    void applySavedSlot(EffectSlot& slot, const SavedSlot& saved);  // Plugin state and slot settings
+
+    // Modulation routes targeting one slot, compiled into parallel arrays so the
+    // audio thread walks only this slot's routes with no per-route lookups
+    struct SlotRouteTable
+    {
+        std::vector<int> sourceRows;          // Row in the ModulationEngine control matrix
+        std::vector<double> scaledAmounts;    // Route amount * target parameter range
+        std::vector<clap_id> paramIds;
+        std::vector<void*> cookies;
+        uint32_t cookieGeneration = 0;        // Cookies are only sent while the plugin still reports this
+        uint64_t pluginInstanceId = 0;        // The plugin the routes (and cookies) were compiled for
+
+        size_t size() const { return paramIds.size(); }
+    };
+
+    // Consecutive slots that process the same input. A group of one is an
+    // ordinary serial slot; larger groups run on the worker pool and are summed.
+    struct SlotGroup
+    {
+        size_t first = 0;
+        size_t count = 1;
+    };
+
+    // Consecutive groups run by one thread in pipelined mode
+    struct PipelineStage
+    {
+        size_t firstGroup = 0;
+        size_t numGroups = 0;
+    };
+
+    // Immutable view of the chain seen by the audio thread. Holding the slots by
+    // shared_ptr keeps removed plugins alive until the snapshot is reclaimed.
+    struct ChainSnapshot
+    {
+        std::vector<std::shared_ptr<EffectSlot>> slots;
+        std::vector<SlotRouteTable> routeTables;  // One per slot
+        std::vector<SlotGroup> groups;            // Processing order, covers every slot
+        std::vector<PipelineStage> stages;        // Empty unless pipelined (then 2+ stages)
+    };
+
+    // Message thread: swap in a snapshot of effectChain and the compiled
+    // modulation routes, retire the old one. Call after any chain or route edit.
+    void publishChain();
+    void compileRouteTables(ChainSnapshot& snapshot);
+
+    // Message thread, after any edit that moves or removes slots (before
+    // publishing): point each route back at the slot holding its plugin, and
+    // drop routes whose plugin has left the chain
+    void retargetModulationRoutes();
+
+    // Peak hold with decay for the level meters
+    static void updatePeakMeter(std::atomic<float>& meter, float peak)
+    {
+        const float current = meter.load();
+        meter.store(peak > current ? peak : current * 0.95f);
+    }
+
+    // Fold any number of channels onto a left/right meter pair: even channels
+    // to the left, odd to the right (mono feeds both). Returns the mean RMS.
+    static float updateLevelMeters(std::atomic<float>& left, std::atomic<float>& right,
+                                   const ChannelLevels* levels, int numChannels);
+
+    static std::vector<SlotGroup> compileGroups(const std::vector<std::shared_ptr<EffectSlot>>& slots);
+    void compilePipeline(ChainSnapshot& snapshot) const;
+    bool routeCookiesAreStale() const;
+    void reclaimRetiredChains();
+    void timerCallback() override;
+
+    // Message thread: deactivate and reactivate the CLAP plugins that asked for
+    // a restart (clap_host::request_restart), then re-query their latency
+    void handleCLAPRestartRequests();
+
+    // Message thread: refresh each slot's latency and report the chain total to
+    // the host. CLAP plugins are only re-queried when forced or when they have
+    // signalled a change.
+    void updateLatency(const ChainSnapshot& chain, bool requeryCLAP);
+
+    // Message thread: drain the parameter events CLAP plugins have sent from
+    // their own GUIs and tell the host the wrapper's state has changed - once
+    // per completed gesture, and once per batch for changes outside a gesture
+    void drainCLAPParamEvents(const ChainSnapshot& chain);
+    uint32_t clapParamValueGeneration = 0;  // Message thread
+
+    // Total chain latency: slowest child of each group plus the pipeline delay.
+    // Reads only atomics and the snapshot, so it is safe on either thread.
+    int getChainLatency(const ChainSnapshot& chain) const;
+    int getDuckerLatency() const;
+
+    // Audio thread: pin the published snapshot for the duration of a block
+    ChainSnapshot* acquireChain();
+    void releaseChain();
+
+    std::atomic<ChainSnapshot*> publishedChain{nullptr};
+    std::atomic<ChainSnapshot*> audioActiveChain{nullptr};  // Snapshot the audio thread is using
+    std::vector<std::unique_ptr<ChainSnapshot>> retiredChains;
+    juce::CriticalSection retiredChainsLock;
+
+    // The audio path, instantiated for float and double (SampleType is the
+    // host's precision, which scratch was prepared for)
+    template <typename SampleType>
+    void processBlockInPrecision(juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages);
+
+    // Processes at most scratch.getMaxBlockSize() samples
+    template <typename SampleType>
+    void processChunk(const ChainSnapshot& chain, juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages);
+
+    // Runs one slot (gain, plugin, mix, meters) in place on buffer. Called from
+    // the audio thread, or from a worker for slots in a parallel group.
+    template <typename SampleType>
+    void processSlot(const ChainSnapshot& chain, size_t slotIndex, juce::AudioBuffer<SampleType>& buffer,
+                     juce::MidiBuffer& midiMessages, int slotLatency);
+
+    // The plugin call inside processSlot, in the plugin's own precision
+    template <typename PluginSampleType>
+    void processPlugin(const ChainSnapshot& chain, size_t slotIndex, juce::AudioBuffer<PluginSampleType>& buffer,
+                       juce::MidiBuffer& midiMessages, int slotLatency, bool inputSilent, uint64_t constantChannels);
+
+    template <typename SampleType>
+    void processParallelGroup(const ChainSnapshot& chain, const SlotGroup& group,
+                              juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages, bool useWorkers);
+    template <typename SampleType>
+    void processPipelined(const ChainSnapshot& chain, juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages);
+
+    AudioWorkerPool workerPool;
+    bool pipelinedChain = false;  // Message thread; compiled into the snapshot
+    std::vector<PipelineStage> activePipelineStages;  // Audio thread: layout the stage FIFOs hold audio for
+    int64_t parallelSavedTicks = 0;  // Audio thread: job time overlapped by the pool this block
+
+    // Preallocated audio-thread memory
+    RealtimeScratch scratch;
+    int64_t reportedAllocationCount = 0;  // Message thread: last RealtimeAllocationCheck count logged
+
+    // Per-block modulation source values shared by all slots
+    ModulationEngine modulationEngine { NUM_LFOS, NUM_ENVELOPES, NUM_STEP_SEQS, NUM_MACROS };
+
+    // Ducker DSP (audio thread only)
+    Ducker ducker;
+
+    // Smoothed master trim and mix (audio thread only)
+    SmoothedGain masterInputGain;
+    SmoothedGain masterOutputGain;
+    SmoothedGain masterWetMix;
     double currentSampleRate = 44100.0;
 
     // Cached macro parameter pointers (avoid string lookup on audio thread)
     std::atomic<float>* macroParams[NUM_MACROS] = {nullptr};
+    std::atomic<float>* inputGainParam = nullptr;
+    std::atomic<float>* outputGainParam = nullptr;
+    std::atomic<float>* mixParam = nullptr;
 
+    // Lets async load callbacks outlive the processor
+    JUCE_DECLARE_WEAK_REFERENCEABLE (UhbikWrapperAudioProcessor)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (UhbikWrapperAudioProcessor)
 };
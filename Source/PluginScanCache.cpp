@@ -0,0 +1,280 @@
+#include "PluginScanCache.h"
+#include <iostream>
+
+namespace
+{
+    constexpr int CACHE_VERSION = 1;
+
+    const char* formatName(PluginScanCache::Format format)
+    {
+        return format == PluginScanCache::Format::CLAP ? "CLAP" : "VST3";
+    }
+}
+
+PluginScanCache::PluginScanCache()
+    : cacheFile(getDefaultFile())
+{
+    reload();
+}
+
+juce::File PluginScanCache::getDefaultFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("UhbikWrapper")
+        .getChildFile("PluginScanCache.xml");
+}
+
+PluginScanCache::Stamp PluginScanCache::stampFor(const juce::File& file)
+{
+    Stamp stamp;
+    stamp.modTime = file.getLastModificationTime().toMilliseconds();
+
+    if (!file.isDirectory())
+    {
+        stamp.size = file.getSize();
+        return stamp;
+    }
+
+    // Bundles (.vst3 / .clap on macOS): any file inside changing counts
+    for (const auto& entry : juce::RangedDirectoryIterator(file, true, "*", juce::File::findFiles))
+    {
+        stamp.modTime = juce::jmax(stamp.modTime, entry.getModificationTime().toMilliseconds());
+        stamp.size += entry.getFileSize();
+    }
+
+    return stamp;
+}
+
+// ============================================================================
+// Disk I/O
+// ============================================================================
+
+void PluginScanCache::reload()
+{
+    juce::InterProcessLock::ScopedLockType lock(fileLock);
+
+    const auto modTime = cacheFile.getLastModificationTime();
+    if (modTime == lastReadModTime)
+        return;
+
+    std::map<juce::String, Bundle> merged;
+    readFile(merged);
+
+    // Our unsaved results win over the file
+    for (const auto& [key, stored] : pendingChanges)
+    {
+        if (!stored)
+            merged.erase(key);
+        else if (auto it = bundles.find(key); it != bundles.end())
+            merged[key] = std::move(it->second);
+    }
+
+    bundles = std::move(merged);
+    lastReadModTime = modTime;
+}
+
+void PluginScanCache::save()
+{
+    if (pendingChanges.empty())
+        return;
+
+    juce::InterProcessLock::ScopedLockType lock(fileLock);
+
+    // Another process may have written since we read - merge rather than clobber
+    std::map<juce::String, Bundle> merged;
+    readFile(merged);
+
+    for (const auto& [key, stored] : pendingChanges)
+    {
+        if (!stored)
+            merged.erase(key);
+        else if (auto it = bundles.find(key); it != bundles.end())
+            merged[key] = std::move(it->second);
+    }
+
+    writeFile(merged);
+    bundles = std::move(merged);
+    pendingChanges.clear();
+    lastReadModTime = cacheFile.getLastModificationTime();
+}
+
+void PluginScanCache::readFile(std::map<juce::String, Bundle>& into) const
+{
+    if (!cacheFile.existsAsFile())
+        return;
+
+    auto xml = juce::XmlDocument::parse(cacheFile);
+    if (xml == nullptr || !xml->hasTagName("UhbikPluginScanCache")
+        || xml->getIntAttribute("version") != CACHE_VERSION)
+    {
+        std::cerr << "[RACK] Ignoring unreadable plugin scan cache: " << cacheFile.getFullPathName() << std::endl;
+        return;
+    }
+
+    for (auto* bundleXml : xml->getChildWithTagNameIterator("Bundle"))
+    {
+        Bundle bundle;
+        bundle.format = bundleXml->getStringAttribute("format") == "CLAP" ? Format::CLAP : Format::VST3;
+        bundle.stamp.modTime = bundleXml->getStringAttribute("modTime").getLargeIntValue();
+        bundle.stamp.size = bundleXml->getStringAttribute("size").getLargeIntValue();
+        bundle.plugins = std::make_unique<juce::XmlElement>(*bundleXml);
+
+        const auto path = bundleXml->getStringAttribute("path");
+        into[keyFor(bundle.format, path)] = std::move(bundle);
+    }
+}
+
+void PluginScanCache::writeFile(const std::map<juce::String, Bundle>& from) const
+{
+    juce::XmlElement xml("UhbikPluginScanCache");
+    xml.setAttribute("version", CACHE_VERSION);
+
+    for (const auto& entry : from)
+    {
+        if (entry.second.plugins != nullptr)
+            xml.addChildElement(new juce::XmlElement(*entry.second.plugins));
+    }
+
+    cacheFile.getParentDirectory().createDirectory();
+
+    // Readers in other processes never see a half-written file
+    juce::TemporaryFile temp(cacheFile);
+    if (!xml.writeTo(temp.getFile()) || !temp.overwriteTargetFileWithTemporary())
+        std::cerr << "[RACK] Failed to write plugin scan cache: " << cacheFile.getFullPathName() << std::endl;
+}
+
+// ============================================================================
+// Lookup
+// ============================================================================
+
+juce::String PluginScanCache::keyFor(Format format, const juce::String& path)
+{
+    return juce::String(formatName(format)) + "|" + path;
+}
+
+const PluginScanCache::Bundle* PluginScanCache::findBundle(Format format, const juce::String& path, const Stamp& stamp) const
+{
+    auto it = bundles.find(keyFor(format, path));
+    if (it == bundles.end() || it->second.stamp != stamp || it->second.plugins == nullptr)
+        return nullptr;
+
+    return &it->second;
+}
+
+void PluginScanCache::storeBundle(Format format, const juce::String& path, const Stamp& stamp,
+                                  std::unique_ptr<juce::XmlElement> plugins)
+{
+    plugins->setAttribute("format", formatName(format));
+    plugins->setAttribute("path", path);
+    plugins->setAttribute("modTime", juce::String(stamp.modTime));
+    plugins->setAttribute("size", juce::String(stamp.size));
+
+    const auto key = keyFor(format, path);
+    auto& bundle = bundles[key];
+    bundle.format = format;
+    bundle.stamp = stamp;
+    bundle.plugins = std::move(plugins);
+    pendingChanges[key] = true;
+}
+
+bool PluginScanCache::findVST3(const juce::String& path, const Stamp& stamp,
+                               juce::OwnedArray<juce::PluginDescription>& results) const
+{
+    const auto* bundle = findBundle(Format::VST3, path, stamp);
+    if (bundle == nullptr)
+        return false;
+
+    for (auto* pluginXml : bundle->plugins->getChildIterator())
+    {
+        auto desc = std::make_unique<juce::PluginDescription>();
+        if (desc->loadFromXml(*pluginXml))
+            results.add(desc.release());
+    }
+
+    return true;
+}
+
+bool PluginScanCache::findCLAP(const juce::String& path, const Stamp& stamp,
+                               std::vector<CLAPPluginDescription>& results) const
+{
+    const auto* bundle = findBundle(Format::CLAP, path, stamp);
+    if (bundle == nullptr)
+        return false;
+
+    for (auto* pluginXml : bundle->plugins->getChildWithTagNameIterator("CLAP"))
+    {
+        CLAPPluginDescription desc;
+        if (loadCLAPXml(*pluginXml, desc))
+            results.push_back(desc);
+    }
+
+    return true;
+}
+
+void PluginScanCache::storeVST3(const juce::String& path, const Stamp& stamp,
+                                const juce::OwnedArray<juce::PluginDescription>& results)
+{
+    auto plugins = std::make_unique<juce::XmlElement>("Bundle");
+    for (const auto* desc : results)
+        plugins->addChildElement(desc->createXml().release());
+
+    storeBundle(Format::VST3, path, stamp, std::move(plugins));
+}
+
+void PluginScanCache::storeCLAP(const juce::String& path, const Stamp& stamp,
+                                const std::vector<CLAPPluginDescription>& results)
+{
+    auto plugins = std::make_unique<juce::XmlElement>("Bundle");
+    for (const auto& desc : results)
+        plugins->addChildElement(createCLAPXml(desc).release());
+
+    storeBundle(Format::CLAP, path, stamp, std::move(plugins));
+}
+
+std::unique_ptr<juce::XmlElement> PluginScanCache::createCLAPXml(const CLAPPluginDescription& desc)
+{
+    auto xml = std::make_unique<juce::XmlElement>("CLAP");
+    xml->setAttribute("id", desc.pluginId);
+    xml->setAttribute("name", desc.name);
+    xml->setAttribute("vendor", desc.vendor);
+    xml->setAttribute("version", desc.version);
+    xml->setAttribute("description", desc.description);
+    xml->setAttribute("path", desc.pluginPath);
+    xml->setAttribute("instrument", desc.isInstrument);
+    xml->setAttribute("gui", desc.hasGUI);
+    return xml;
+}
+
+bool PluginScanCache::loadCLAPXml(const juce::XmlElement& xml, CLAPPluginDescription& desc)
+{
+    if (!xml.hasTagName("CLAP"))
+        return false;
+
+    desc.pluginId = xml.getStringAttribute("id");
+    desc.name = xml.getStringAttribute("name");
+    desc.vendor = xml.getStringAttribute("vendor");
+    desc.version = xml.getStringAttribute("version");
+    desc.description = xml.getStringAttribute("description");
+    desc.pluginPath = xml.getStringAttribute("path");
+    desc.isInstrument = xml.getBoolAttribute("instrument");
+    desc.hasGUI = xml.getBoolAttribute("gui");
+    return desc.isValid();
+}
+
+void PluginScanCache::retainOnly(Format format, const juce::StringArray& seenPaths)
+{
+    const juce::String prefix = juce::String(formatName(format)) + "|";
+
+    for (auto it = bundles.begin(); it != bundles.end();)
+    {
+        if (it->first.startsWith(prefix) && !seenPaths.contains(it->first.substring(prefix.length())))
+        {
+            pendingChanges[it->first] = false;
+            it = bundles.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <map>
+#include <vector>
+#include "CLAPPluginHost.h"
+
+// On-disk cache of plugin scan results, shared by every wrapper instance in
+// every process. Each bundle is keyed by path and stamped with its modification
+// time and size; a bundle is only loaded (and its results replaced) when the
+// stamp changes. Bundles that failed to scan are cached as empty so they aren't
+// retried until they change.
+//
+// Message thread only. Wrapper instances in one process share a single cache
+// through juce::SharedResourcePointer; other processes are picked up by
+// reload(), which re-reads the file when it has changed on disk. All file
+// access is guarded by an InterProcessLock.
+class PluginScanCache
+{
+public:
+    enum class Format
+    {
+        VST3,
+        CLAP
+    };
+
+    struct Stamp
+    {
+        juce::int64 modTime = 0;  // Milliseconds since epoch; newest file in a bundle
+        juce::int64 size = 0;     // Bytes; summed over a bundle
+
+        bool operator==(const Stamp& other) const { return modTime == other.modTime && size == other.size; }
+        bool operator!=(const Stamp& other) const { return !(*this == other); }
+    };
+
+    PluginScanCache();
+
+    static juce::File getDefaultFile();
+
+    // Stamp for a plugin file or bundle directory (directories are walked)
+    static Stamp stampFor(const juce::File& file);
+
+    // Merge in whatever other processes have written since the last call
+    void reload();
+
+    // Write pending changes (merged with the current file contents)
+    void save();
+
+    // Cached results for a bundle whose stamp still matches. Returns false on a
+    // miss; true with an empty list means the bundle is known to hold nothing.
+    bool findVST3(const juce::String& path, const Stamp& stamp, juce::OwnedArray<juce::PluginDescription>& results) const;
+    bool findCLAP(const juce::String& path, const Stamp& stamp, std::vector<CLAPPluginDescription>& results) const;
+
+    void storeVST3(const juce::String& path, const Stamp& stamp, const juce::OwnedArray<juce::PluginDescription>& results);
+    void storeCLAP(const juce::String& path, const Stamp& stamp, const std::vector<CLAPPluginDescription>& results);
+
+    // Forget bundles of this format that weren't seen in the latest scan
+    void retainOnly(Format format, const juce::StringArray& seenPaths);
+
+    // CLAP descriptor <-> <CLAP> element (also the scan worker's wire format)
+    static std::unique_ptr<juce::XmlElement> createCLAPXml(const CLAPPluginDescription& desc);
+    static bool loadCLAPXml(const juce::XmlElement& xml, CLAPPluginDescription& desc);
+
+private:
+    struct Bundle
+    {
+        Format format = Format::VST3;
+        Stamp stamp;
+        std::unique_ptr<juce::XmlElement> plugins;  // <PLUGIN> / <CLAP> children
+    };
+
+    static juce::String keyFor(Format format, const juce::String& path);
+    const Bundle* findBundle(Format format, const juce::String& path, const Stamp& stamp) const;
+    void storeBundle(Format format, const juce::String& path, const Stamp& stamp, std::unique_ptr<juce::XmlElement> plugins);
+
+    void readFile(std::map<juce::String, Bundle>& into) const;
+    void writeFile(const std::map<juce::String, Bundle>& from) const;
+
+    juce::File cacheFile;
+    juce::InterProcessLock fileLock { "UhbikWrapperPluginScanCache" };
+    juce::Time lastReadModTime;
+
+    std::map<juce::String, Bundle> bundles;
+    std::map<juce::String, bool> pendingChanges;  // Key -> true if stored, false if removed
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginScanCache)
+};
@@ -0,0 +1,114 @@
+#include "RealtimeScratch.h"
+#include <cstdlib>
+#include <new>
+
+#ifndef UHBIK_CHECK_RT_ALLOCATIONS
+    #define UHBIK_CHECK_RT_ALLOCATIONS 0
+#endif
+
+// ============================================================================
+// RealtimeScratch
+// ============================================================================
+
+void RealtimeScratch::prepare(int newNumMainChannels, int newMaxBlockSize, double sampleRate, bool useDoublePrecision)
+{
+    numMainChannels = juce::jlimit(1, MAX_MAIN_CHANNELS, newNumMainChannels);
+    maxBlockSize = juce::jmax(1, newMaxBlockSize);
+    gainRampSamples = juce::jmax(1, juce::roundToInt(sampleRate * GAIN_RAMP_SECONDS));
+    doublePrecision = useDoublePrecision;
+
+    masterDryBuffer.setSize(numMainChannels, maxBlockSize, doublePrecision);
+    masterDryDelay.prepare(numMainChannels, CompensationDelay::MASTER_CAPACITY, maxBlockSize, doublePrecision);
+
+    for (auto& stage : pipelineStages)
+        stage.prepare(getNumChainChannels(), maxBlockSize, doublePrecision);
+
+    chunkMidi.ensureSize(CHUNK_MIDI_BYTES);
+}
+
+juce::MidiBuffer& RealtimeScratch::getChunkMidi(const juce::MidiBuffer& source, int start, int numSamples)
+{
+    chunkMidi.clear();
+    for (auto it = source.findNextSamplePosition(start); it != source.cend(); ++it)
+    {
+        const auto metadata = *it;
+        if (metadata.samplePosition >= start + numSamples)
+            break;
+
+        chunkMidi.addEvent(metadata.data, metadata.numBytes, metadata.samplePosition - start);
+    }
+    return chunkMidi;
+}
+
+void RealtimeScratch::prepareSlot(SlotScratch& slotScratch, bool pluginUsesDouble, int numPadChannels) const
+{
+    slotScratch.prepare(numMainChannels, getNumChainChannels(), maxBlockSize, gainRampSamples,
+                        doublePrecision, doublePrecision && !pluginUsesDouble, numPadChannels);
+}
+
+// ============================================================================
+// ScopedAudioThread
+// ============================================================================
+
+namespace
+{
+    thread_local int audioThreadDepth = 0;
+}
+
+ScopedAudioThread::ScopedAudioThread() { ++audioThreadDepth; }
+ScopedAudioThread::~ScopedAudioThread() { --audioThreadDepth; }
+bool ScopedAudioThread::isCurrentThread() { return audioThreadDepth > 0; }
+
+// ============================================================================
+// RealtimeAllocationCheck
+// ============================================================================
+
+#if UHBIK_CHECK_RT_ALLOCATIONS
+
+namespace
+{
+    std::atomic<int64_t> audioThreadAllocations{0};
+
+    void noteAllocation()
+    {
+        if (audioThreadDepth <= 0)
+            return;
+
+        audioThreadAllocations.fetch_add(1, std::memory_order_relaxed);
+
+        // The assertion handler allocates itself - don't recurse into it
+        const int depth = audioThreadDepth;
+        audioThreadDepth = 0;
+        jassertfalse;  // Heap allocation inside processBlock
+        audioThreadDepth = depth;
+    }
+
+    void* checkedAllocate(std::size_t size)
+    {
+        noteAllocation();
+        if (void* ptr = std::malloc(size == 0 ? 1 : size))
+            return ptr;
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(std::size_t size) { return checkedAllocate(size); }
+void* operator new[](std::size_t size) { return checkedAllocate(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace RealtimeAllocationCheck
+{
+    int64_t getAllocationCount() { return audioThreadAllocations.load(std::memory_order_relaxed); }
+}
+
+#else
+
+namespace RealtimeAllocationCheck
+{
+    int64_t getAllocationCount() { return 0; }
+}
+
+#endif
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "DelayCompensation.h"
+#include "GainMixKernel.h"
+#include "SamplePrecision.h"
+#include "SilenceTracker.h"
+
+// Scratch memory used by the audio thread. Everything in here is sized on the
+// message thread (prepareToPlay, or when a slot is created) so that
+// processBlock never has to touch the heap. Audio buffers are allocated in
+// the processing precision only (see DualPrecisionBuffer).
+
+// Per-slot scratch - owned by the slot itself, so it is always sized before the
+// slot becomes visible to the audio thread
+struct SlotScratch
+{
+    DualPrecisionBuffer dryBuffer;  // Pre-effect copy for the slot's wet/dry mix
+    CompensationDelay dryDelay;     // Aligns dryBuffer with the plugin's latency
+
+    // Double-precision chain with a plugin that only takes float: the plugin
+    // runs on a float copy (main + sidechain channels). Empty otherwise.
+    juce::AudioBuffer<float> convertBuffer;
+
+    // VST3 plugin channels with no counterpart in the slot buffer (a sidechain
+    // the host doesn't send, channels beyond the wrapper's main bus), one per
+    // plugin channel, in the plugin's precision. Empty for CLAP.
+    DualPrecisionBuffer padBuffer;
+
+    // Parallel branches: each child processes its own copy of the group input
+    DualPrecisionBuffer branchBuffer;  // Main + sidechain channels
+    CompensationDelay alignDelay;      // Pads the child up to the group's latency
+    juce::MidiBuffer branchMidi;
+    int64_t processTicks = 0;               // Time spent in the last job (CPU display)
+
+    // Smoothed per-slot trim and mix (audio thread state)
+    SmoothedGain inputGain;
+    SmoothedGain outputGain;
+    SmoothedGain wetMix;
+
+    // Skips the plugin while its input is silent and its tail has played out
+    SilenceTracker silence;
+
+    void prepare(int numChannels, int numBranchChannels, int maxBlockSize, int gainRampSamples,
+                 bool doublePrecision, bool convertToFloat, int numPadChannels)
+    {
+        silence.reset();
+        inputGain.prepare(gainRampSamples);
+        outputGain.prepare(gainRampSamples);
+        wetMix.prepare(gainRampSamples);
+
+        dryBuffer.setSize(numChannels, maxBlockSize, doublePrecision);
+        dryDelay.prepare(numChannels, CompensationDelay::SLOT_CAPACITY, maxBlockSize, doublePrecision);
+
+        convertBuffer.setSize(convertToFloat ? numBranchChannels : 0, convertToFloat ? maxBlockSize : 0,
+                              false, true, false);
+        padBuffer.setSize(numPadChannels, maxBlockSize, doublePrecision && !convertToFloat);
+
+        branchBuffer.setSize(numBranchChannels, maxBlockSize, doublePrecision);
+        alignDelay.prepare(numChannels, CompensationDelay::SLOT_CAPACITY, maxBlockSize, doublePrecision);
+        branchMidi.ensureSize(2048);
+    }
+};
+
+// Working memory for one stage of the pipelined chain
+struct PipelineStageScratch
+{
+    DualPrecisionBuffer buffer;  // Main + sidechain channels
+    juce::MidiBuffer midi;
+    PipelineFifo output;         // Feeds the next stage one block later
+    int64_t processTicks = 0;    // Time spent in the last block (CPU display)
+
+    void prepare(int numChannels, int maxBlockSize, bool doublePrecision)
+    {
+        buffer.setSize(numChannels, maxBlockSize, doublePrecision);
+        midi.ensureSize(2048);
+        output.prepare(numChannels, maxBlockSize, doublePrecision);
+    }
+};
+
+// Processor-wide scratch (master dry path, pipeline stages). Chain buffers
+// hold the main bus channels followed by the sidechain.
+class RealtimeScratch
+{
+public:
+    static constexpr int MOD_BLOCK_SIZE = 64;           // Modulation granularity in samples
+    static constexpr int MAX_MAIN_CHANNELS = 16;        // Up to 9.1.6 / 16 discrete
+    static constexpr int MAX_SIDECHAIN_CHANNELS = 2;    // Mono or stereo key
+    static constexpr int MAX_PIPELINE_STAGES = 8;
+    static constexpr double GAIN_RAMP_SECONDS = 0.02;   // Trim / mix smoothing time
+    static constexpr int CHUNK_MIDI_BYTES = 8192;       // About 800 short messages per chunk
+
+    RealtimeScratch() = default;
+
+    // Message thread only. pluginUsesDouble: the slot's plugin was negotiated
+    // to double precision (irrelevant for a float chain). numPadChannels: see
+    // SlotScratch::padBuffer.
+    void prepare(int numMainChannels, int maxBlockSize, double sampleRate, bool doublePrecision);
+    void prepareSlot(SlotScratch& slotScratch, bool pluginUsesDouble, int numPadChannels) const;
+
+    bool isDoublePrecision() const { return doublePrecision; }
+    int getMaxBlockSize() const { return maxBlockSize; }
+    int getNumMainChannels() const { return numMainChannels; }
+    int getNumChainChannels() const { return numMainChannels + MAX_SIDECHAIN_CHANNELS; }  // Main + sidechain
+    int getGainRampSamples() const { return gainRampSamples; }
+
+    // Audio thread. SampleType must match the precision given to prepare().
+    template <typename SampleType>
+    juce::AudioBuffer<SampleType>& getMasterDryBuffer() { return masterDryBuffer.get<SampleType>(); }
+    CompensationDelay& getMasterDryDelay() { return masterDryDelay; }
+    PipelineStageScratch& getPipelineStage(int stage) { return pipelineStages[static_cast<size_t>(stage)]; }
+
+    // Audio thread: the events of source in [start, start + numSamples), moved
+    // to chunk-relative positions, for hosts that send blocks larger than the
+    // prepared size. Preallocated for CHUNK_MIDI_BYTES; busier chunks grow it.
+    juce::MidiBuffer& getChunkMidi(const juce::MidiBuffer& source, int start, int numSamples);
+
+private:
+    int numMainChannels = 2;
+    int maxBlockSize = 512;
+    int gainRampSamples = 882;
+    bool doublePrecision = false;
+
+    DualPrecisionBuffer masterDryBuffer;
+    CompensationDelay masterDryDelay;
+    std::array<PipelineStageScratch, MAX_PIPELINE_STAGES> pipelineStages;
+    juce::MidiBuffer chunkMidi;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealtimeScratch)
+};
+
+// Marks the current thread as an audio thread while alive: the host's thread
+// inside processBlock, and pool workers while they run jobs. CLAP plugins ask
+// through clap_host_thread_check::is_audio_thread.
+struct ScopedAudioThread
+{
+    ScopedAudioThread();
+    ~ScopedAudioThread();
+
+    static bool isCurrentThread();
+};
+
+// Debug aid for catching audio-thread allocations. Build with
+// -DUHBIK_CHECK_RT_ALLOCATIONS=ON to replace the global operator new: every
+// allocation made while a ScopedAudioThread is alive is counted, and asserts in
+// debug builds. The processor's timer logs the count as it grows. Without the
+// option these are no-ops.
+namespace RealtimeAllocationCheck
+{
+    int64_t getAllocationCount();
+}
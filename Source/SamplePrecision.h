@@ -0,0 +1,114 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <type_traits>
+
+#if JUCE_USE_SSE_INTRINSICS
+    #include <emmintrin.h>
+#elif JUCE_USE_ARM_NEON && (defined(__aarch64__) || defined(_M_ARM64))
+    #include <arm_neon.h>
+    #define UHBIK_USE_NEON_F64 1
+#endif
+
+// The chain runs in whatever precision the host processes in (float or
+// double). Slots whose plugin can't take that precision convert at the slot
+// boundary - nowhere else.
+
+// Vectorised float <-> double conversion. JUCE's FloatVectorOperations has no
+// mixed-type copy, so this does two (SSE2 / AArch64 NEON) or one sample per
+// step with a scalar tail. src and dest must not overlap.
+namespace SampleConversion
+{
+    inline void convert(double* dest, const float* src, int numSamples)
+    {
+        int i = 0;
+       #if JUCE_USE_SSE_INTRINSICS
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            const __m128 in = _mm_loadu_ps(src + i);
+            _mm_storeu_pd(dest + i, _mm_cvtps_pd(in));
+            _mm_storeu_pd(dest + i + 2, _mm_cvtps_pd(_mm_movehl_ps(in, in)));
+        }
+       #elif UHBIK_USE_NEON_F64
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            const float32x4_t in = vld1q_f32(src + i);
+            vst1q_f64(dest + i, vcvt_f64_f32(vget_low_f32(in)));
+            vst1q_f64(dest + i + 2, vcvt_high_f64_f32(in));
+        }
+       #endif
+        for (; i < numSamples; ++i)
+            dest[i] = static_cast<double>(src[i]);
+    }
+
+    inline void convert(float* dest, const double* src, int numSamples)
+    {
+        int i = 0;
+       #if JUCE_USE_SSE_INTRINSICS
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            const __m128 low = _mm_cvtpd_ps(_mm_loadu_pd(src + i));
+            const __m128 high = _mm_cvtpd_ps(_mm_loadu_pd(src + i + 2));
+            _mm_storeu_ps(dest + i, _mm_movelh_ps(low, high));
+        }
+       #elif UHBIK_USE_NEON_F64
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            const float32x2_t low = vcvt_f32_f64(vld1q_f64(src + i));
+            vst1q_f32(dest + i, vcvt_high_f32_f64(low, vld1q_f64(src + i + 2)));
+        }
+       #endif
+        for (; i < numSamples; ++i)
+            dest[i] = static_cast<float>(src[i]);
+    }
+
+    // Channel by channel between two buffers of different sample types
+    template <typename DestType, typename SourceType>
+    void convert(juce::AudioBuffer<DestType>& dest, const juce::AudioBuffer<SourceType>& src,
+                 int numChannels, int numSamples)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            convert(dest.getWritePointer(ch), src.getReadPointer(ch), numSamples);
+    }
+}
+
+// A scratch buffer that exists in both sample types. Only the one for the
+// precision passed to setSize() is allocated; the other is left empty.
+class DualPrecisionBuffer
+{
+public:
+    // Message thread
+    void setSize(int numChannels, int numSamples, bool doublePrecision)
+    {
+        floatBuffer.setSize(doublePrecision ? 0 : numChannels, doublePrecision ? 0 : numSamples, false, true, false);
+        doubleBuffer.setSize(doublePrecision ? numChannels : 0, doublePrecision ? numSamples : 0, false, true, false);
+    }
+
+    void clear()
+    {
+        floatBuffer.clear();
+        doubleBuffer.clear();
+    }
+
+    template <typename SampleType>
+    juce::AudioBuffer<SampleType>& get()
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleBuffer;
+        else
+            return floatBuffer;
+    }
+
+    template <typename SampleType>
+    const juce::AudioBuffer<SampleType>& get() const
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleBuffer;
+        else
+            return floatBuffer;
+    }
+
+private:
+    juce::AudioBuffer<float> floatBuffer;
+    juce::AudioBuffer<double> doubleBuffer;
+};
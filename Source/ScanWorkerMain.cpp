@@ -0,0 +1,76 @@
+// UhbikScanWorker - loads plugin bundles on behalf of the wrapper so that a
+// crashing or hanging plugin can't take the host down. Launched by
+// ScanWorkerPool as:
+//
+//     UhbikScanWorker --scan-vst3|--scan-clap <bundle path>...
+//
+// For every bundle it prints one line to stdout:
+//
+//     UHBIK_SCAN_RESULT <Bundle path="..."><PLUGIN .../>...</Bundle>
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <iostream>
+#include "CLAPPluginHost.h"
+#include "PluginScanCache.h"
+#include "ScanWorkerPool.h"
+
+namespace
+{
+    std::unique_ptr<juce::XmlElement> scanVST3(juce::AudioPluginFormat& format, const juce::String& path)
+    {
+        auto bundle = std::make_unique<juce::XmlElement>("Bundle");
+        bundle->setAttribute("path", path);
+
+        juce::OwnedArray<juce::PluginDescription> found;
+        format.findAllTypesForFile(found, path);
+        for (const auto* desc : found)
+            bundle->addChildElement(desc->createXml().release());
+
+        return bundle;
+    }
+
+    std::unique_ptr<juce::XmlElement> scanCLAP(const juce::String& path)
+    {
+        auto bundle = std::make_unique<juce::XmlElement>("Bundle");
+        bundle->setAttribute("path", path);
+
+        CLAPPluginScanner scanner;
+        scanner.scanFile(juce::File(path));
+        for (const auto& desc : scanner.getPlugins())
+            bundle->addChildElement(PluginScanCache::createCLAPXml(desc).release());
+
+        return bundle;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // VST3 scanning instantiates plugins, which needs a message manager
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(juce::String::fromUTF8(argv[i]));
+
+    if (args.size() < 2 || (args[0] != ScanWorkerPool::VST3_ARGUMENT && args[0] != ScanWorkerPool::CLAP_ARGUMENT))
+    {
+        std::cerr << "Usage: UhbikScanWorker " << ScanWorkerPool::VST3_ARGUMENT << "|"
+                  << ScanWorkerPool::CLAP_ARGUMENT << " <bundle>..." << std::endl;
+        return 1;
+    }
+
+    const bool isCLAP = args[0] == ScanWorkerPool::CLAP_ARGUMENT;
+    juce::VST3PluginFormat vst3Format;
+
+    for (int i = 1; i < args.size(); ++i)
+    {
+        auto bundle = isCLAP ? scanCLAP(args[i]) : scanVST3(vst3Format, args[i]);
+
+        // Start on a fresh line in case a plugin left its own output unterminated
+        std::cout << '\n' << ScanWorkerPool::RESULT_PREFIX
+                  << bundle->toString(juce::XmlElement::TextFormat().singleLine().withoutHeader())
+                  << std::endl;
+    }
+
+    return 0;
+}
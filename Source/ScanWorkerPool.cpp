@@ -0,0 +1,251 @@
+#include "ScanWorkerPool.h"
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    constexpr int POLL_INTERVAL_MS = 10;
+
+    juce::String workerFileName()
+    {
+       #if JUCE_WINDOWS
+        return "UhbikScanWorker.exe";
+       #else
+        return "UhbikScanWorker";
+       #endif
+    }
+}
+
+// ============================================================================
+// WorkerProcess - one child process plus the thread draining its stdout
+// ============================================================================
+
+class ScanWorkerPool::WorkerProcess : public juce::Thread
+{
+public:
+    WorkerProcess(const juce::File& executable, PluginScanCache::Format format, const juce::StringArray& paths)
+        : juce::Thread("Uhbik Scan Worker Reader")
+    {
+        arguments.add(executable.getFullPathName());
+        arguments.add(format == PluginScanCache::Format::CLAP ? CLAP_ARGUMENT : VST3_ARGUMENT);
+        arguments.addArray(paths);
+    }
+
+    ~WorkerProcess() override
+    {
+        process.kill();
+        stopThread(2000);
+    }
+
+    bool launch()
+    {
+        if (!process.start(arguments, juce::ChildProcess::wantStdOut))
+            return false;
+
+        lastProgressMs.store(juce::Time::getMillisecondCounter());
+        startThread();
+        return true;
+    }
+
+    bool hasTimedOut() const
+    {
+        return juce::Time::getMillisecondCounter() - lastProgressMs.load() > static_cast<juce::uint32>(BUNDLE_TIMEOUT_MS);
+    }
+
+    void kill() { process.kill(); }
+
+    // Only after the thread has finished
+    ResultMap& getResults() { return results; }
+
+    void run() override
+    {
+        std::string pending;
+        char buffer[4096];
+
+        // Returns 0 once the child exits (or is killed) and the pipe closes
+        for (;;)
+        {
+            const int numRead = process.readProcessOutput(buffer, static_cast<int>(sizeof(buffer)));
+            if (numRead <= 0)
+                break;
+
+            pending.append(buffer, static_cast<size_t>(numRead));
+
+            size_t lineEnd;
+            while ((lineEnd = pending.find('\n')) != std::string::npos)
+            {
+                handleLine(pending.substr(0, lineEnd));
+                pending.erase(0, lineEnd + 1);
+            }
+        }
+
+        handleLine(pending);
+    }
+
+private:
+    void handleLine(const std::string& line)
+    {
+        // Plugins print to stdout too - only our prefixed lines count
+        const auto prefixPos = line.find(RESULT_PREFIX);
+        if (prefixPos == std::string::npos)
+            return;
+
+        const auto xmlText = juce::String::fromUTF8(line.data() + prefixPos + std::strlen(RESULT_PREFIX),
+                                                    static_cast<int>(line.size() - prefixPos - std::strlen(RESULT_PREFIX)));
+        auto bundle = juce::XmlDocument::parse(xmlText);
+        if (bundle == nullptr || !bundle->hasTagName("Bundle"))
+            return;
+
+        const auto path = bundle->getStringAttribute("path");
+        results[path] = std::move(bundle);
+        lastProgressMs.store(juce::Time::getMillisecondCounter());
+    }
+
+    juce::StringArray arguments;
+    juce::ChildProcess process;
+    ResultMap results;
+    std::atomic<juce::uint32> lastProgressMs{0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WorkerProcess)
+};
+
+// ============================================================================
+// ScanWorkerPool
+// ============================================================================
+
+ScanWorkerPool::ScanWorkerPool()
+    : workerExecutable(findWorkerExecutable()),
+      numProcesses(juce::jlimit(1, MAX_PROCESSES, juce::SystemStats::getNumCpus()))
+{
+    if (isAvailable())
+        std::cerr << "[RACK] Scan worker: " << workerExecutable.getFullPathName() << std::endl;
+    else
+        std::cerr << "[RACK] No scan worker found - plugins will be scanned in-process" << std::endl;
+}
+
+ScanWorkerPool::~ScanWorkerPool() = default;
+
+juce::File ScanWorkerPool::findWorkerExecutable()
+{
+    const auto fromEnvironment = juce::SystemStats::getEnvironmentVariable("UHBIK_SCAN_WORKER", {});
+    if (fromEnvironment.isNotEmpty() && juce::File::isAbsolutePath(fromEnvironment) && juce::File(fromEnvironment).existsAsFile())
+        return juce::File(fromEnvironment);
+
+    // The build copies the worker next to the plugin binary inside each bundle
+    const auto besideBinary = juce::File::getSpecialLocation(juce::File::currentExecutableFile).getSiblingFile(workerFileName());
+    if (besideBinary.existsAsFile())
+        return besideBinary;
+
+    const auto inAppData = PluginScanCache::getDefaultFile().getSiblingFile(workerFileName());
+    if (inAppData.existsAsFile())
+        return inAppData;
+
+    return {};
+}
+
+std::map<juce::String, std::unique_ptr<juce::XmlElement>> ScanWorkerPool::scan(PluginScanCache::Format format,
+                                                                               const juce::StringArray& paths)
+{
+    ResultMap results;
+    if (paths.isEmpty())
+        return results;
+
+    const auto startMs = juce::Time::getMillisecondCounter();
+
+    // Round-robin shards, one per process
+    std::vector<juce::StringArray> shards(static_cast<size_t>(juce::jmin(numProcesses, paths.size())));
+    for (int i = 0; i < paths.size(); ++i)
+        shards[static_cast<size_t>(i) % shards.size()].add(paths[i]);
+
+    runRound(format, shards, results);
+
+    // Whatever a crashed or hung worker didn't finish gets its own process, so
+    // one bad bundle can't sink the rest of its shard
+    std::vector<juce::StringArray> retries;
+    for (const auto& path : paths)
+    {
+        if (results.find(path) == results.end())
+            retries.push_back(juce::StringArray(path));
+    }
+
+    if (!retries.empty())
+    {
+        std::cerr << "[RACK] Retrying " << retries.size() << " bundles in isolated scan workers" << std::endl;
+        runRound(format, retries, results);
+    }
+
+    for (const auto& path : paths)
+    {
+        if (results.find(path) != results.end())
+            continue;
+
+        std::cerr << "[RACK] Scan failed (crash or timeout): " << path << std::endl;
+        auto failed = std::make_unique<juce::XmlElement>("Bundle");
+        failed->setAttribute("path", path);
+        failed->setAttribute("failed", true);
+        results[path] = std::move(failed);
+    }
+
+    std::cerr << "[RACK] Scanned " << paths.size() << " bundles in " << shards.size() << " worker processes ("
+              << static_cast<int>(juce::Time::getMillisecondCounter() - startMs) << " ms)" << std::endl;
+    return results;
+}
+
+void ScanWorkerPool::runRound(PluginScanCache::Format format, const std::vector<juce::StringArray>& shards, ResultMap& results)
+{
+    std::vector<std::unique_ptr<WorkerProcess>> running;
+    size_t nextShard = 0;
+
+    while (nextShard < shards.size() || !running.empty())
+    {
+        while (static_cast<int>(running.size()) < numProcesses && nextShard < shards.size())
+        {
+            auto worker = std::make_unique<WorkerProcess>(workerExecutable, format, shards[nextShard++]);
+            if (worker->launch())
+                running.push_back(std::move(worker));
+            else
+                std::cerr << "[RACK] Failed to launch scan worker" << std::endl;
+        }
+
+        juce::Thread::sleep(POLL_INTERVAL_MS);
+
+        for (auto it = running.begin(); it != running.end();)
+        {
+            auto& worker = **it;
+            if (!worker.isThreadRunning())
+            {
+                for (auto& [path, bundle] : worker.getResults())
+                    results[path] = std::move(bundle);
+                it = running.erase(it);
+                continue;
+            }
+
+            // Its reader thread finishes once the pipe closes
+            if (worker.hasTimedOut())
+                worker.kill();
+
+            ++it;
+        }
+    }
+}
+
+void ScanWorkerPool::readVST3Results(const juce::XmlElement& bundle, juce::OwnedArray<juce::PluginDescription>& results)
+{
+    for (auto* pluginXml : bundle.getChildIterator())
+    {
+        auto desc = std::make_unique<juce::PluginDescription>();
+        if (desc->loadFromXml(*pluginXml))
+            results.add(desc.release());
+    }
+}
+
+void ScanWorkerPool::readCLAPResults(const juce::XmlElement& bundle, std::vector<CLAPPluginDescription>& results)
+{
+    for (auto* pluginXml : bundle.getChildIterator())
+    {
+        CLAPPluginDescription desc;
+        if (PluginScanCache::loadCLAPXml(*pluginXml, desc))
+            results.push_back(desc);
+    }
+}
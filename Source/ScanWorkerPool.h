@@ -0,0 +1,59 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <map>
+#include <memory>
+#include <vector>
+#include "PluginScanCache.h"
+
+// Scans plugin bundles out of process. The wrapper launches up to
+// MAX_PROCESSES copies of the UhbikScanWorker executable, each with a shard of
+// the bundle paths; every worker prints one result line per bundle on stdout
+// as soon as it has it. A plugin that crashes or hangs only takes its worker
+// down: the worker is killed once it has gone BUNDLE_TIMEOUT_MS without a
+// result, and whatever it didn't finish is retried one bundle per process.
+// Bundles that fail twice come back empty (and get cached that way).
+//
+// If no worker executable can be found, isAvailable() is false and callers
+// scan in-process as before.
+class ScanWorkerPool
+{
+public:
+    static constexpr int MAX_PROCESSES = 8;
+    static constexpr int BUNDLE_TIMEOUT_MS = 20000;  // Silence from a worker for this long = hung
+
+    // Wire protocol shared with ScanWorkerMain.cpp
+    static constexpr const char* VST3_ARGUMENT = "--scan-vst3";
+    static constexpr const char* CLAP_ARGUMENT = "--scan-clap";
+    static constexpr const char* RESULT_PREFIX = "UHBIK_SCAN_RESULT ";
+
+    ScanWorkerPool();
+    ~ScanWorkerPool();
+
+    // $UHBIK_SCAN_WORKER, then next to the wrapper binary, then the app-data folder
+    static juce::File findWorkerExecutable();
+
+    bool isAvailable() const { return workerExecutable.existsAsFile(); }
+
+    // Message thread - blocks until every path has a result. Returns one
+    // <Bundle path="..."> element per path holding <PLUGIN> (VST3) or <CLAP>
+    // children; failed bundles are empty and marked failed="1".
+    std::map<juce::String, std::unique_ptr<juce::XmlElement>> scan(PluginScanCache::Format format,
+                                                                   const juce::StringArray& paths);
+
+    // Decode a result element
+    static void readVST3Results(const juce::XmlElement& bundle, juce::OwnedArray<juce::PluginDescription>& results);
+    static void readCLAPResults(const juce::XmlElement& bundle, std::vector<CLAPPluginDescription>& results);
+
+private:
+    class WorkerProcess;
+
+    using ResultMap = std::map<juce::String, std::unique_ptr<juce::XmlElement>>;
+
+    void runRound(PluginScanCache::Format format, const std::vector<juce::StringArray>& shards, ResultMap& results);
+
+    juce::File workerExecutable;
+    int numProcesses = 1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScanWorkerPool)
+};
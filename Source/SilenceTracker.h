@@ -0,0 +1,108 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <cmath>
+#include <limits>
+
+// Decides when a slot can stop calling its plugin. Once the slot's input has
+// been silent for longer than the plugin's tail plus latency, the plugin's
+// output is silent too and the slot goes to sleep; the first non-silent input
+// block wakes it. CLAP plugins can end this early (CLAP_PROCESS_SLEEP) or
+// hold it off (CLAP_PROCESS_CONTINUE) through the status they return.
+//
+// Audio thread only; one per slot.
+class SilenceTracker
+{
+public:
+    static constexpr float SILENCE_THRESHOLD = 1.0e-6f;  // About -120 dBFS
+    static constexpr int INFINITE_TAIL = -1;
+    static constexpr int MAX_TAIL_SAMPLES = 1 << 28;  // Longer tails are treated as infinite
+
+    // VST3 reports 0 both for kNoTail and when a plugin never implements
+    // getTailSamples (JUCE can't tell them apart), so a VST3 slot stays awake
+    // at least this long after its input goes quiet
+    static constexpr double MIN_VST3_TAIL_SECONDS = 3.0;
+
+    // A VST3 plugin's reported tail in samples, held to the minimum above.
+    // Anything too long to count is as good as endless.
+    static int vst3TailSamples(double tailSeconds, double sampleRate)
+    {
+        const double tail = std::ceil(juce::jmax(tailSeconds, MIN_VST3_TAIL_SECONDS) * sampleRate);
+        return std::isfinite(tail) && tail <= MAX_TAIL_SAMPLES ? static_cast<int>(tail) : INFINITE_TAIL;
+    }
+
+    void reset()
+    {
+        silentSamples = 0;
+        sleeping = false;
+    }
+
+    bool isSleeping() const { return sleeping; }
+
+    template <typename SampleType>
+    static bool isSilent(const SampleType* const* channels, int numChannels, int numSamples)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto range = juce::FloatVectorOperations::findMinAndMax(channels[ch], numSamples);
+            if (range.getStart() < -SILENCE_THRESHOLD || range.getEnd() > SILENCE_THRESHOLD)
+                return false;
+        }
+        return true;
+    }
+
+    // Same test, from the same min/max pass as CLAP's constant_mask: returns a
+    // bit per channel (the first 64) whose samples are all equal, and sets
+    // silent if every channel is within the threshold
+    template <typename SampleType>
+    static uint64_t findConstantChannels(const SampleType* const* channels, int numChannels, int numSamples, bool& silent)
+    {
+        uint64_t constantMask = 0;
+        silent = true;
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto range = juce::FloatVectorOperations::findMinAndMax(channels[ch], numSamples);
+            if (range.getStart() < -SILENCE_THRESHOLD || range.getEnd() > SILENCE_THRESHOLD)
+                silent = false;
+            if (ch < 64 && range.getStart() == range.getEnd())
+                constantMask |= uint64_t(1) << ch;
+        }
+        return constantMask;
+    }
+
+    // Before the plugin would run. Returns false while asleep, i.e. the plugin
+    // can be skipped for this block.
+    bool shouldProcess(bool inputSilent)
+    {
+        if (!inputSilent)
+        {
+            silentSamples = 0;
+            sleeping = false;
+        }
+        return !sleeping;
+    }
+
+    // After the plugin has processed a block. ringOutSamples is how long its
+    // output can stay non-silent after the input goes quiet (tail + latency),
+    // or INFINITE_TAIL to keep it awake.
+    void processed(bool inputSilent, int numSamples, int ringOutSamples)
+    {
+        if (!inputSilent)
+            return;
+
+        silentSamples = juce::jmin(silentSamples + numSamples, std::numeric_limits<int>::max() / 2);
+        if (ringOutSamples != INFINITE_TAIL && silentSamples >= ringOutSamples)
+            sleeping = true;
+    }
+
+    // The plugin reports that it has nothing more to output for silent input
+    void pluginIsQuiet(bool inputSilent)
+    {
+        if (inputSilent)
+            sleeping = true;
+    }
+
+private:
+    int silentSamples = 0;
+    bool sleeping = false;
+};
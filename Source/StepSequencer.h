@@ -1,6 +1,7 @@
 #pragma once
 
 #include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
 #include <array>
 #include <cmath>
 
@@ -145,6 +146,60 @@ public:
         return freeRunning ? tickFreeRunning() : tick();
     }
 
+    // Advance by numSamples and write the value process() would return at samples
+    // 0, stride, 2*stride... into out (ceil(numSamples / stride) values).
+    // Step lengths are computed once per block and whole steps are skipped
+    // analytically instead of accumulating progress sample by sample.
+    void renderBlock(float* out, int numSamples, int stride)
+    {
+        const bool canAdvance = currentSampleRate > 0.0 && (freeRunning || tempoBPM > 0.0);
+
+        // Progress per sample for even and odd (swung) steps
+        float evenIncrement = 0.0f;
+        float oddIncrement = 0.0f;
+        if (canAdvance)
+        {
+            if (freeRunning)
+            {
+                float samplesPerStep = static_cast<float>(currentSampleRate) / (freeRateHz * static_cast<float>(numSteps));
+                evenIncrement = oddIncrement = 1.0f / samplesPerStep;
+            }
+            else
+            {
+                double samplesPerStep = currentSampleRate * (60.0 / tempoBPM) * (4.0 / static_cast<double>(division));
+                evenIncrement = 1.0f / static_cast<float>(samplesPerStep);
+                oddIncrement = swing > 0.0f ? 1.0f / static_cast<float>(samplesPerStep * (1.0f + swing * 0.5f))
+                                            : evenIncrement;
+            }
+        }
+
+        int advanced = 0;
+        int numPoints = 0;
+
+        for (int sample = 0; sample < numSamples; sample += stride)
+        {
+            // process() advances before computing its value, so sample n sees n + 1 steps
+            if (canAdvance)
+            {
+                advance(sample + 1 - advanced, evenIncrement, oddIncrement);
+                out[numPoints++] = updateValue();
+            }
+            else
+            {
+                out[numPoints++] = (currentValue - 0.5f) * 2.0f;
+            }
+            advanced = sample + 1;
+        }
+
+        if (canAdvance)
+        {
+            advance(numSamples - advanced, evenIncrement, oddIncrement);
+            updateValue();
+        }
+
+        juce::FloatVectorOperations::multiply(out, depth, numPoints);
+    }
+
     // Depth control
     void setDepth(float d) { depth = juce::jlimit(0.0f, 1.0f, d); }
     float getDepth() const { return depth; }
@@ -217,6 +272,46 @@ public:
     }
 
 private:
+    // Equivalent to numSamples process() calls with fixed step lengths
+    void advance(int numSamples, float evenIncrement, float oddIncrement)
+    {
+        while (numSamples > 0)
+        {
+            const float increment = (currentStep % 2) == 1 ? oddIncrement : evenIncrement;
+            const int samplesToNextStep = juce::jmax(1, static_cast<int>(std::ceil((1.0f - stepProgress) / increment)));
+
+            if (numSamples < samplesToNextStep)
+            {
+                stepProgress += static_cast<float>(numSamples) * increment;
+                return;
+            }
+
+            numSamples -= samplesToNextStep;
+            stepProgress += static_cast<float>(samplesToNextStep) * increment - 1.0f;
+            previousValue = steps[static_cast<size_t>(currentStep)];
+            currentStep = (currentStep + 1) % numSteps;
+        }
+    }
+
+    // Recompute currentValue from the current step/glide position; returns it
+    // without depth applied, bipolar
+    float updateValue()
+    {
+        float targetValue = steps[static_cast<size_t>(currentStep)];
+
+        if (glide > 0.0f)
+        {
+            float glideProgress = juce::jmin(1.0f, stepProgress / glide);
+            currentValue = previousValue + (targetValue - previousValue) * glideProgress;
+        }
+        else
+        {
+            currentValue = targetValue;
+        }
+
+        return (currentValue - 0.5f) * 2.0f;
+    }
+
     double currentSampleRate = 44100.0;
     double tempoBPM = 120.0;
 
@@ -0,0 +1,175 @@
+// UhbikTests - unit tests for the pieces of the wrapper that run without a
+// host or plugins. Built by default (-DUHBIK_BUILD_TESTS=OFF to skip) and run
+// by ctest:
+//
+//     UhbikTests [category]...
+//
+// Runs every test when no category is named. Returns non-zero on failure.
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <iostream>
+#include "RealtimeScratch.h"
+#include "SilenceTracker.h"
+
+namespace
+{
+    // ------------------------------------------------------------------------
+    // Host blocks larger than the prepared size are processed in chunks; each
+    // chunk must see only its own MIDI, at chunk-relative positions
+    // ------------------------------------------------------------------------
+    class ChunkMidiTests : public juce::UnitTest
+    {
+    public:
+        ChunkMidiTests() : juce::UnitTest("Chunk MIDI", "realtime") {}
+
+        void runTest() override
+        {
+            constexpr int PREPARED_BLOCK = 256;
+            constexpr int HOST_BLOCK = 1000;
+
+            RealtimeScratch scratch;
+            scratch.prepare(2, PREPARED_BLOCK, 48000.0, false);
+
+            juce::MidiBuffer hostMidi;
+            hostMidi.addEvent(juce::MidiMessage::noteOff(1, 60), 10);
+            hostMidi.addEvent(juce::MidiMessage::noteOn(1, 64, 0.8f), 300);  // Second chunk
+            hostMidi.addEvent(juce::MidiMessage::controllerEvent(1, 1, 64), PREPARED_BLOCK * 3);  // First sample of the fourth
+
+            beginTest("Note-on in the second chunk of an oversized block");
+            {
+                int chunkIndex = 0;
+                int totalEvents = 0;
+                for (int start = 0; start < HOST_BLOCK; start += PREPARED_BLOCK, ++chunkIndex)
+                {
+                    const int chunkSamples = juce::jmin(PREPARED_BLOCK, HOST_BLOCK - start);
+                    const auto& chunkMidi = scratch.getChunkMidi(hostMidi, start, chunkSamples);
+
+                    for (const auto metadata : chunkMidi)
+                    {
+                        ++totalEvents;
+                        expect(metadata.samplePosition >= 0 && metadata.samplePosition < chunkSamples,
+                               "Event outside its chunk: " + juce::String(metadata.samplePosition));
+
+                        const auto message = metadata.getMessage();
+                        if (message.isNoteOn())
+                        {
+                            expectEquals(chunkIndex, 1);
+                            expectEquals(metadata.samplePosition, 300 - PREPARED_BLOCK);
+                            expectEquals(message.getNoteNumber(), 64);
+                        }
+                        else if (message.isNoteOff())
+                        {
+                            expectEquals(chunkIndex, 0);
+                            expectEquals(metadata.samplePosition, 10);
+                        }
+                        else
+                        {
+                            expectEquals(chunkIndex, 3);
+                            expectEquals(metadata.samplePosition, 0);
+                        }
+                    }
+                }
+                expectEquals(totalEvents, hostMidi.getNumEvents());
+            }
+
+            beginTest("Each call replaces the previous chunk's events");
+            {
+                scratch.getChunkMidi(hostMidi, 0, PREPARED_BLOCK);
+                expect(scratch.getChunkMidi(hostMidi, PREPARED_BLOCK * 2, PREPARED_BLOCK).isEmpty());
+            }
+        }
+    };
+
+    ChunkMidiTests chunkMidiTests;
+
+    // ------------------------------------------------------------------------
+    // A slot sleeps once its input has been silent for its tail plus latency.
+    // A VST3 tail of 0 may just mean "not reported", so it must not put the
+    // slot to sleep after the first silent block.
+    // ------------------------------------------------------------------------
+    class SilenceTrackerTests : public juce::UnitTest
+    {
+    public:
+        SilenceTrackerTests() : juce::UnitTest("Silence tracker", "realtime") {}
+
+        void runTest() override
+        {
+            constexpr double SAMPLE_RATE = 48000.0;
+            constexpr int BLOCK = 512;
+
+            beginTest("VST3 reporting no tail is held for the minimum");
+            {
+                const int ringOut = SilenceTracker::vst3TailSamples(0.0, SAMPLE_RATE);
+                expectEquals(ringOut, static_cast<int>(SilenceTracker::MIN_VST3_TAIL_SECONDS * SAMPLE_RATE));
+
+                SilenceTracker silence;
+                expect(silence.shouldProcess(true));
+                silence.processed(true, BLOCK, ringOut);
+                expect(!silence.isSleeping(), "Asleep after one silent block");
+
+                int silentSamples = BLOCK;
+                while (silentSamples < ringOut)
+                {
+                    expect(silence.shouldProcess(true));
+                    silence.processed(true, BLOCK, ringOut);
+                    silentSamples += BLOCK;
+                }
+                expect(silence.isSleeping());
+                expect(!silence.shouldProcess(true));
+                expect(silence.shouldProcess(false), "Sound must wake the slot");
+            }
+
+            beginTest("Longer VST3 tails are kept; endless ones never sleep");
+            {
+                expectEquals(SilenceTracker::vst3TailSamples(10.0, SAMPLE_RATE), static_cast<int>(10.0 * SAMPLE_RATE));
+                expectEquals(SilenceTracker::vst3TailSamples(std::numeric_limits<double>::infinity(), SAMPLE_RATE),
+                             SilenceTracker::INFINITE_TAIL);
+
+                SilenceTracker silence;
+                for (int i = 0; i < 1000; ++i)
+                    silence.processed(true, BLOCK, SilenceTracker::INFINITE_TAIL);
+                expect(!silence.isSleeping());
+            }
+
+            beginTest("Non-silent input restarts the count");
+            {
+                SilenceTracker silence;
+                silence.processed(true, BLOCK, BLOCK * 2);
+                expect(silence.shouldProcess(false));
+                silence.processed(false, BLOCK, BLOCK * 2);
+                silence.processed(true, BLOCK, BLOCK * 2);
+                expect(!silence.isSleeping());
+                silence.processed(true, BLOCK, BLOCK * 2);
+                expect(silence.isSleeping());
+            }
+        }
+    };
+
+    SilenceTrackerTests silenceTrackerTests;
+}
+
+int main(int argc, char* argv[])
+{
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+
+    if (argc < 2)
+    {
+        runner.runAllTests();
+    }
+    else
+    {
+        for (int i = 1; i < argc; ++i)
+            runner.runTestsInCategory(argv[i]);
+    }
+
+    int failures = 0;
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        failures += runner.getResult(i)->failures;
+
+    if (failures == 0)
+        std::cout << "All tests passed" << std::endl;
+    else
+        std::cout << failures << " failure(s)" << std::endl;
+    return failures == 0 ? 0 : 1;
+}